@@ -33,6 +33,7 @@
 // A_GLSL .... Using GLSL.
 // A_HLSL .... Using HLSL.
 // A_GCC ..... Using a GCC compatible compiler (else assume MSVC compatible compiler by default).
+// A_SSE ..... CPU float vector ops on SSE, off by default.
 // =======
 // A_BYTE .... Support 8-bit integer.
 // A_HALF .... Support 16-bit integer and floating point.
@@ -64,6 +65,13 @@
 //------------------------------------------------------------------------------------------------------------------------------
 // CHANGE LOG
 // ==========
+// 20261017 - A_SSE is off by default, the CPU ASse*F4() and AAvxPrx*F8() forms only need SSE2 (A_CPU_SSE).
+// 20261017 - CPU AAvxPrx*F8() are built for AVX2 with GCC and Clang (A_AVX_FN), for code picking AVX2 at runtime.
+// 20261017 - Added CPU APrxLoRsqF1(), APrxLo*H1() and APrxLo*H2() on half bits, and SSE and AVX2 forms of the APrx*F1().
+// 20261017 - Added A_SSE, SSE versions of the CPU AF2, AF3, and AF4 vector ops, and ASseF4 to chain them in registers.
+// 20261017 - Added CPU AF1_AH1_AU1(), and AH1N_AF1N() and AF1N_AH1N() to convert whole arrays (F16C where available).
+// 20261017 - Added CPU A_CONSTEXPR and A_BIT_CAST, the setup functions and AU1_AH1_AF1() can run at compile time.
+// 20261017 - Added CPU AF1_AU1(), AMax3F1(), AMin3F1(), and float approximations, CPU ASat*() now saturates NaN to 0.
 // 20190531 - Fixed changed to llabs() because long is int on Windows.
 // 20190530 - Updated for new CPU/GPU portability.
 // 20190528 - Fix AU1_AH2_x() on HLSL (had incorrectly swapped x and y), fixed asuint() cases.
@@ -118,6 +126,42 @@
  #ifndef A_STATIC
   #define A_STATIC static
  #endif
+//------------------------------------------------------------------------------------------------------------------------------
+ // Type reinterpretation through a bit cast builtin when there is one (GCC 11, Clang 9), otherwise through a union.
+ #ifndef A_BIT_CAST
+  #if defined(__cplusplus)&&defined(__has_builtin)
+   #if __has_builtin(__builtin_bit_cast)
+    #define A_BIT_CAST 1
+   #endif
+  #endif
+ #endif
+//------------------------------------------------------------------------------------------------------------------------------
+ // Marks the scalar functions which can run in constant expressions (C++14 with A_BIT_CAST), otherwise empty.
+ // Define it empty before including to keep everything runtime only.
+ #ifndef A_CONSTEXPR
+  #if defined(A_BIT_CAST)&&(__cplusplus>=201402L)
+   #define A_CONSTEXPR constexpr
+  #else
+   #define A_CONSTEXPR
+  #endif
+ #endif
+//------------------------------------------------------------------------------------------------------------------------------
+ // SSE versions of the AF2, AF3, and AF4 vector ops, define A_SSE to 1 before including to replace the scalar ones.
+ // The ASse*F4() register forms are there whenever the compiler targets SSE2 (A_CPU_SSE), whatever A_SSE is.
+ #ifndef A_SSE
+  #define A_SSE 0
+ #endif
+ #if defined(__SSE2__)||defined(_M_X64)||(defined(_M_IX86_FP)&&(_M_IX86_FP>=2))
+  #define A_CPU_SSE 1
+ #elif A_SSE
+  #error A_SSE needs a compiler targeting SSE2
+ #endif
+ #ifdef A_CPU_SSE
+  #include <emmintrin.h>
+  #if defined(__AVX2__)||(defined(A_GCC)&&(defined(__x86_64__)||defined(__i386__)))
+   #include <immintrin.h>
+  #endif
+ #endif
 //------------------------------------------------------------------------------------------------------------------------------
  // Same types across CPU and GPU.
  // Predicate uses 32-bit integer (C friendly bool).
@@ -141,7 +185,13 @@
  #define ASL1_(a) ((ASL1)(a))
  #define ASU1_(a) ((ASU1)(a))
 //------------------------------------------------------------------------------------------------------------------------------
- A_STATIC AU1 AU1_AF1(AF1 a){union{AF1 f;AU1 u;}bits;bits.f=a;return bits.u;}
+ #ifdef A_BIT_CAST
+  A_STATIC A_CONSTEXPR AF1 AF1_AU1(AU1 a){return __builtin_bit_cast(AF1,a);}
+  A_STATIC A_CONSTEXPR AU1 AU1_AF1(AF1 a){return __builtin_bit_cast(AU1,a);}
+ #else
+  A_STATIC AF1 AF1_AU1(AU1 a){union{AU1 u;AF1 f;}bits;bits.u=a;return bits.f;}
+  A_STATIC AU1 AU1_AF1(AF1 a){union{AF1 f;AU1 u;}bits;bits.f=a;return bits.u;}
+ #endif
 //------------------------------------------------------------------------------------------------------------------------------
  #define A_TRUE 1
  #define A_FALSE 0
@@ -298,8 +348,8 @@
   A_STATIC AF1 AFloorF1(AF1 a){return floorf(a);}
  #endif
 //------------------------------------------------------------------------------------------------------------------------------
- A_STATIC AD1 ALerpD1(AD1 a,AD1 b,AD1 c){return b*c+(-a*c+a);}
- A_STATIC AF1 ALerpF1(AF1 a,AF1 b,AF1 c){return b*c+(-a*c+a);}
+ A_STATIC A_CONSTEXPR AD1 ALerpD1(AD1 a,AD1 b,AD1 c){return b*c+(-a*c+a);}
+ A_STATIC A_CONSTEXPR AF1 ALerpF1(AF1 a,AF1 b,AF1 c){return b*c+(-a*c+a);}
 //------------------------------------------------------------------------------------------------------------------------------
  #ifdef A_GCC
   A_STATIC AD1 ALog2D1(AD1 a){return __builtin_log2(a);}
@@ -309,25 +359,25 @@
   A_STATIC AF1 ALog2F1(AF1 a){return log2f(a);}
  #endif
 //------------------------------------------------------------------------------------------------------------------------------
- A_STATIC AD1 AMaxD1(AD1 a,AD1 b){return a>b?a:b;}
- A_STATIC AF1 AMaxF1(AF1 a,AF1 b){return a>b?a:b;}
- A_STATIC AL1 AMaxL1(AL1 a,AL1 b){return a>b?a:b;}
- A_STATIC AU1 AMaxU1(AU1 a,AU1 b){return a>b?a:b;}
+ A_STATIC A_CONSTEXPR AD1 AMaxD1(AD1 a,AD1 b){return a>b?a:b;}
+ A_STATIC A_CONSTEXPR AF1 AMaxF1(AF1 a,AF1 b){return a>b?a:b;}
+ A_STATIC A_CONSTEXPR AL1 AMaxL1(AL1 a,AL1 b){return a>b?a:b;}
+ A_STATIC A_CONSTEXPR AU1 AMaxU1(AU1 a,AU1 b){return a>b?a:b;}
 //------------------------------------------------------------------------------------------------------------------------------
  // These follow the convention that A integer types don't have signage, until they are operated on. 
- A_STATIC AL1 AMaxSL1(AL1 a,AL1 b){return (ASL1_(a)>ASL1_(b))?a:b;}
- A_STATIC AU1 AMaxSU1(AU1 a,AU1 b){return (ASU1_(a)>ASU1_(b))?a:b;}
+ A_STATIC A_CONSTEXPR AL1 AMaxSL1(AL1 a,AL1 b){return (ASL1_(a)>ASL1_(b))?a:b;}
+ A_STATIC A_CONSTEXPR AU1 AMaxSU1(AU1 a,AU1 b){return (ASU1_(a)>ASU1_(b))?a:b;}
 //------------------------------------------------------------------------------------------------------------------------------
- A_STATIC AD1 AMinD1(AD1 a,AD1 b){return a<b?a:b;}
- A_STATIC AF1 AMinF1(AF1 a,AF1 b){return a<b?a:b;}
- A_STATIC AL1 AMinL1(AL1 a,AL1 b){return a<b?a:b;}
- A_STATIC AU1 AMinU1(AU1 a,AU1 b){return a<b?a:b;}
+ A_STATIC A_CONSTEXPR AD1 AMinD1(AD1 a,AD1 b){return a<b?a:b;}
+ A_STATIC A_CONSTEXPR AF1 AMinF1(AF1 a,AF1 b){return a<b?a:b;}
+ A_STATIC A_CONSTEXPR AL1 AMinL1(AL1 a,AL1 b){return a<b?a:b;}
+ A_STATIC A_CONSTEXPR AU1 AMinU1(AU1 a,AU1 b){return a<b?a:b;}
 //------------------------------------------------------------------------------------------------------------------------------
- A_STATIC AL1 AMinSL1(AL1 a,AL1 b){return (ASL1_(a)<ASL1_(b))?a:b;}
- A_STATIC AU1 AMinSU1(AU1 a,AU1 b){return (ASU1_(a)<ASU1_(b))?a:b;}
+ A_STATIC A_CONSTEXPR AL1 AMinSL1(AL1 a,AL1 b){return (ASL1_(a)<ASL1_(b))?a:b;}
+ A_STATIC A_CONSTEXPR AU1 AMinSU1(AU1 a,AU1 b){return (ASU1_(a)<ASU1_(b))?a:b;}
 //------------------------------------------------------------------------------------------------------------------------------
- A_STATIC AD1 ARcpD1(AD1 a){return 1.0/a;}
- A_STATIC AF1 ARcpF1(AF1 a){return 1.0f/a;}
+ A_STATIC A_CONSTEXPR AD1 ARcpD1(AD1 a){return 1.0/a;}
+ A_STATIC A_CONSTEXPR AF1 ARcpF1(AF1 a){return 1.0f/a;}
 //------------------------------------------------------------------------------------------------------------------------------
  A_STATIC AL1 AShrSL1(AL1 a,AL1 b){return AL1_(ASL1_(a)>>ASL1_(b));}
  A_STATIC AU1 AShrSU1(AU1 a,AU1 b){return AU1_(ASU1_(a)>>ASU1_(b));}
@@ -362,8 +412,36 @@
  A_STATIC AD1 ARsqD1(AD1 a){return ARcpD1(ASqrtD1(a));}
  A_STATIC AF1 ARsqF1(AF1 a){return ARcpF1(ASqrtF1(a));}
 //------------------------------------------------------------------------------------------------------------------------------
- A_STATIC AD1 ASatD1(AD1 a){return AMinD1(1.0,AMaxD1(0.0,a));}
- A_STATIC AF1 ASatF1(AF1 a){return AMinF1(1.0f,AMaxF1(0.0f,a));}
+ // Operand order makes NaN saturate to 0 like the GPU.
+ A_STATIC A_CONSTEXPR AD1 ASatD1(AD1 a){return AMinD1(AMaxD1(a,0.0),1.0);}
+ A_STATIC A_CONSTEXPR AF1 ASatF1(AF1 a){return AMinF1(AMaxF1(a,0.0f),1.0f);}
+//------------------------------------------------------------------------------------------------------------------------------
+ // Same operand ordering as the GPU V_MAX3_F32 and V_MIN3_F32 proxies.
+ A_STATIC A_CONSTEXPR AF1 AMax3F1(AF1 x,AF1 y,AF1 z){return AMaxF1(x,AMaxF1(y,z));}
+ A_STATIC A_CONSTEXPR AF1 AMin3F1(AF1 x,AF1 y,AF1 z){return AMinF1(x,AMinF1(y,z));}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                    FLOAT APPROXIMATIONS
+//------------------------------------------------------------------------------------------------------------------------------
+// CPU ports of the GPU approximations (see the GPU section for docs).
+// The integer tricks produce the same bits as the GPU, the Newton-Raphson step can differ in rounding if the GPU fuses it.
+//==============================================================================================================================
+ A_STATIC A_CONSTEXPR AF1 APrxLoSqrtF1(AF1 a){return AF1_AU1((AU1_AF1(a)>>AU1_(1))+AU1_(0x1fbc4639));}
+ A_STATIC A_CONSTEXPR AF1 APrxLoRcpF1(AF1 a){return AF1_AU1(AU1_(0x7ef07ebb)-AU1_AF1(a));}
+ A_STATIC A_CONSTEXPR AF1 APrxMedRcpF1(AF1 a){AF1 b=AF1_AU1(AU1_(0x7ef19fff)-AU1_AF1(a));return b*(-b*a+AF1_(2.0));}
+ A_STATIC A_CONSTEXPR AF1 APrxLoRsqF1(AF1 a){return AF1_AU1(AU1_(0x5f347d74)-(AU1_AF1(a)>>AU1_(1)));}
+//------------------------------------------------------------------------------------------------------------------------------
+ // Half versions work on the bits since the CPU has no half type.
+ // H1 is a half in the low 16 bits, H2 is two halves packed like AU1_AH2_AF2(), each lane wraps on its own like the GPU.
+ // There is no APrxMedRcpH*(), its Newton-Raphson step needs half precision math.
+ A_STATIC A_CONSTEXPR AU1 APrxLoSqrtH1(AU1 a){return ((a>>AU1_(1))+AU1_(0x1de2))&AU1_(0xffff);}
+ A_STATIC A_CONSTEXPR AU1 APrxLoRcpH1(AU1 a){return (AU1_(0x7784)-a)&AU1_(0xffff);}
+ A_STATIC A_CONSTEXPR AU1 APrxLoRsqH1(AU1 a){return (AU1_(0x59a3)-(a>>AU1_(1)))&AU1_(0xffff);}
+ A_STATIC A_CONSTEXPR AU1 APrxLoSqrtH2(AU1 a){return APrxLoSqrtH1(a&AU1_(0xffff))|(APrxLoSqrtH1(a>>AU1_(16))<<AU1_(16));}
+ A_STATIC A_CONSTEXPR AU1 APrxLoRcpH2(AU1 a){return APrxLoRcpH1(a&AU1_(0xffff))|(APrxLoRcpH1(a>>AU1_(16))<<AU1_(16));}
+ A_STATIC A_CONSTEXPR AU1 APrxLoRsqH2(AU1 a){return APrxLoRsqH1(a&AU1_(0xffff))|(APrxLoRsqH1(a>>AU1_(16))<<AU1_(16));}
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //_____________________________________________________________/\_______________________________________________________________
@@ -377,89 +455,214 @@
  A_STATIC retAD3 opAAbsD3(outAD3 d,inAD3 a){d[0]=AAbsD1(a[0]);d[1]=AAbsD1(a[1]);d[2]=AAbsD1(a[2]);return d;}
  A_STATIC retAD4 opAAbsD4(outAD4 d,inAD4 a){d[0]=AAbsD1(a[0]);d[1]=AAbsD1(a[1]);d[2]=AAbsD1(a[2]);d[3]=AAbsD1(a[3]);return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opAAbsF2(outAF2 d,inAF2 a){d[0]=AAbsF1(a[0]);d[1]=AAbsF1(a[1]);return d;}
  A_STATIC retAF3 opAAbsF3(outAF3 d,inAF3 a){d[0]=AAbsF1(a[0]);d[1]=AAbsF1(a[1]);d[2]=AAbsF1(a[2]);return d;}
  A_STATIC retAF4 opAAbsF4(outAF4 d,inAF4 a){d[0]=AAbsF1(a[0]);d[1]=AAbsF1(a[1]);d[2]=AAbsF1(a[2]);d[3]=AAbsF1(a[3]);return d;}
+ #endif
 //==============================================================================================================================
  A_STATIC retAD2 opAAddD2(outAD2 d,inAD2 a,inAD2 b){d[0]=a[0]+b[0];d[1]=a[1]+b[1];return d;}
  A_STATIC retAD3 opAAddD3(outAD3 d,inAD3 a,inAD3 b){d[0]=a[0]+b[0];d[1]=a[1]+b[1];d[2]=a[2]+b[2];return d;}
  A_STATIC retAD4 opAAddD4(outAD4 d,inAD4 a,inAD4 b){d[0]=a[0]+b[0];d[1]=a[1]+b[1];d[2]=a[2]+b[2];d[3]=a[3]+b[3];return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opAAddF2(outAF2 d,inAF2 a,inAF2 b){d[0]=a[0]+b[0];d[1]=a[1]+b[1];return d;}
  A_STATIC retAF3 opAAddF3(outAF3 d,inAF3 a,inAF3 b){d[0]=a[0]+b[0];d[1]=a[1]+b[1];d[2]=a[2]+b[2];return d;}
  A_STATIC retAF4 opAAddF4(outAF4 d,inAF4 a,inAF4 b){d[0]=a[0]+b[0];d[1]=a[1]+b[1];d[2]=a[2]+b[2];d[3]=a[3]+b[3];return d;}
+ #endif
 //==============================================================================================================================
  A_STATIC retAD2 opACpyD2(outAD2 d,inAD2 a){d[0]=a[0];d[1]=a[1];return d;}
  A_STATIC retAD3 opACpyD3(outAD3 d,inAD3 a){d[0]=a[0];d[1]=a[1];d[2]=a[2];return d;}
  A_STATIC retAD4 opACpyD4(outAD4 d,inAD4 a){d[0]=a[0];d[1]=a[1];d[2]=a[2];d[3]=a[3];return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opACpyF2(outAF2 d,inAF2 a){d[0]=a[0];d[1]=a[1];return d;}
  A_STATIC retAF3 opACpyF3(outAF3 d,inAF3 a){d[0]=a[0];d[1]=a[1];d[2]=a[2];return d;}
  A_STATIC retAF4 opACpyF4(outAF4 d,inAF4 a){d[0]=a[0];d[1]=a[1];d[2]=a[2];d[3]=a[3];return d;}
+ #endif
 //==============================================================================================================================
  A_STATIC retAD2 opALerpD2(outAD2 d,inAD2 a,inAD2 b,inAD2 c){d[0]=ALerpD1(a[0],b[0],c[0]);d[1]=ALerpD1(a[1],b[1],c[1]);return d;}
  A_STATIC retAD3 opALerpD3(outAD3 d,inAD3 a,inAD3 b,inAD3 c){d[0]=ALerpD1(a[0],b[0],c[0]);d[1]=ALerpD1(a[1],b[1],c[1]);d[2]=ALerpD1(a[2],b[2],c[2]);return d;}
  A_STATIC retAD4 opALerpD4(outAD4 d,inAD4 a,inAD4 b,inAD4 c){d[0]=ALerpD1(a[0],b[0],c[0]);d[1]=ALerpD1(a[1],b[1],c[1]);d[2]=ALerpD1(a[2],b[2],c[2]);d[3]=ALerpD1(a[3],b[3],c[3]);return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opALerpF2(outAF2 d,inAF2 a,inAF2 b,inAF2 c){d[0]=ALerpF1(a[0],b[0],c[0]);d[1]=ALerpF1(a[1],b[1],c[1]);return d;}
  A_STATIC retAF3 opALerpF3(outAF3 d,inAF3 a,inAF3 b,inAF3 c){d[0]=ALerpF1(a[0],b[0],c[0]);d[1]=ALerpF1(a[1],b[1],c[1]);d[2]=ALerpF1(a[2],b[2],c[2]);return d;}
  A_STATIC retAF4 opALerpF4(outAF4 d,inAF4 a,inAF4 b,inAF4 c){d[0]=ALerpF1(a[0],b[0],c[0]);d[1]=ALerpF1(a[1],b[1],c[1]);d[2]=ALerpF1(a[2],b[2],c[2]);d[3]=ALerpF1(a[3],b[3],c[3]);return d;}
+ #endif
 //==============================================================================================================================
  A_STATIC retAD2 opALerpOneD2(outAD2 d,inAD2 a,inAD2 b,AD1 c){d[0]=ALerpD1(a[0],b[0],c);d[1]=ALerpD1(a[1],b[1],c);return d;}
  A_STATIC retAD3 opALerpOneD3(outAD3 d,inAD3 a,inAD3 b,AD1 c){d[0]=ALerpD1(a[0],b[0],c);d[1]=ALerpD1(a[1],b[1],c);d[2]=ALerpD1(a[2],b[2],c);return d;}
  A_STATIC retAD4 opALerpOneD4(outAD4 d,inAD4 a,inAD4 b,AD1 c){d[0]=ALerpD1(a[0],b[0],c);d[1]=ALerpD1(a[1],b[1],c);d[2]=ALerpD1(a[2],b[2],c);d[3]=ALerpD1(a[3],b[3],c);return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opALerpOneF2(outAF2 d,inAF2 a,inAF2 b,AF1 c){d[0]=ALerpF1(a[0],b[0],c);d[1]=ALerpF1(a[1],b[1],c);return d;}
  A_STATIC retAF3 opALerpOneF3(outAF3 d,inAF3 a,inAF3 b,AF1 c){d[0]=ALerpF1(a[0],b[0],c);d[1]=ALerpF1(a[1],b[1],c);d[2]=ALerpF1(a[2],b[2],c);return d;}
  A_STATIC retAF4 opALerpOneF4(outAF4 d,inAF4 a,inAF4 b,AF1 c){d[0]=ALerpF1(a[0],b[0],c);d[1]=ALerpF1(a[1],b[1],c);d[2]=ALerpF1(a[2],b[2],c);d[3]=ALerpF1(a[3],b[3],c);return d;}
+ #endif
 //==============================================================================================================================
  A_STATIC retAD2 opAMaxD2(outAD2 d,inAD2 a,inAD2 b){d[0]=AMaxD1(a[0],b[0]);d[1]=AMaxD1(a[1],b[1]);return d;}
  A_STATIC retAD3 opAMaxD3(outAD3 d,inAD3 a,inAD3 b){d[0]=AMaxD1(a[0],b[0]);d[1]=AMaxD1(a[1],b[1]);d[2]=AMaxD1(a[2],b[2]);return d;}
  A_STATIC retAD4 opAMaxD4(outAD4 d,inAD4 a,inAD4 b){d[0]=AMaxD1(a[0],b[0]);d[1]=AMaxD1(a[1],b[1]);d[2]=AMaxD1(a[2],b[2]);d[3]=AMaxD1(a[3],b[3]);return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opAMaxF2(outAF2 d,inAF2 a,inAF2 b){d[0]=AMaxF1(a[0],b[0]);d[1]=AMaxF1(a[1],b[1]);return d;}
  A_STATIC retAF3 opAMaxF3(outAF3 d,inAF3 a,inAF3 b){d[0]=AMaxF1(a[0],b[0]);d[1]=AMaxF1(a[1],b[1]);d[2]=AMaxF1(a[2],b[2]);return d;}
  A_STATIC retAF4 opAMaxF4(outAF4 d,inAF4 a,inAF4 b){d[0]=AMaxF1(a[0],b[0]);d[1]=AMaxF1(a[1],b[1]);d[2]=AMaxF1(a[2],b[2]);d[3]=AMaxF1(a[3],b[3]);return d;}
+ #endif
 //==============================================================================================================================
  A_STATIC retAD2 opAMinD2(outAD2 d,inAD2 a,inAD2 b){d[0]=AMinD1(a[0],b[0]);d[1]=AMinD1(a[1],b[1]);return d;}
  A_STATIC retAD3 opAMinD3(outAD3 d,inAD3 a,inAD3 b){d[0]=AMinD1(a[0],b[0]);d[1]=AMinD1(a[1],b[1]);d[2]=AMinD1(a[2],b[2]);return d;}
  A_STATIC retAD4 opAMinD4(outAD4 d,inAD4 a,inAD4 b){d[0]=AMinD1(a[0],b[0]);d[1]=AMinD1(a[1],b[1]);d[2]=AMinD1(a[2],b[2]);d[3]=AMinD1(a[3],b[3]);return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opAMinF2(outAF2 d,inAF2 a,inAF2 b){d[0]=AMinF1(a[0],b[0]);d[1]=AMinF1(a[1],b[1]);return d;}
  A_STATIC retAF3 opAMinF3(outAF3 d,inAF3 a,inAF3 b){d[0]=AMinF1(a[0],b[0]);d[1]=AMinF1(a[1],b[1]);d[2]=AMinF1(a[2],b[2]);return d;}
  A_STATIC retAF4 opAMinF4(outAF4 d,inAF4 a,inAF4 b){d[0]=AMinF1(a[0],b[0]);d[1]=AMinF1(a[1],b[1]);d[2]=AMinF1(a[2],b[2]);d[3]=AMinF1(a[3],b[3]);return d;}
+ #endif
 //==============================================================================================================================
  A_STATIC retAD2 opAMulD2(outAD2 d,inAD2 a,inAD2 b){d[0]=a[0]*b[0];d[1]=a[1]*b[1];return d;}
  A_STATIC retAD3 opAMulD3(outAD3 d,inAD3 a,inAD3 b){d[0]=a[0]*b[0];d[1]=a[1]*b[1];d[2]=a[2]*b[2];return d;}
  A_STATIC retAD4 opAMulD4(outAD4 d,inAD4 a,inAD4 b){d[0]=a[0]*b[0];d[1]=a[1]*b[1];d[2]=a[2]*b[2];d[3]=a[3]*b[3];return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opAMulF2(outAF2 d,inAF2 a,inAF2 b){d[0]=a[0]*b[0];d[1]=a[1]*b[1];return d;}
  A_STATIC retAF3 opAMulF3(outAF3 d,inAF3 a,inAF3 b){d[0]=a[0]*b[0];d[1]=a[1]*b[1];d[2]=a[2]*b[2];return d;}
  A_STATIC retAF4 opAMulF4(outAF4 d,inAF4 a,inAF4 b){d[0]=a[0]*b[0];d[1]=a[1]*b[1];d[2]=a[2]*b[2];d[3]=a[3]*b[3];return d;}
+ #endif
 //==============================================================================================================================
  A_STATIC retAD2 opAMulOneD2(outAD2 d,inAD2 a,AD1 b){d[0]=a[0]*b;d[1]=a[1]*b;return d;}
  A_STATIC retAD3 opAMulOneD3(outAD3 d,inAD3 a,AD1 b){d[0]=a[0]*b;d[1]=a[1]*b;d[2]=a[2]*b;return d;}
  A_STATIC retAD4 opAMulOneD4(outAD4 d,inAD4 a,AD1 b){d[0]=a[0]*b;d[1]=a[1]*b;d[2]=a[2]*b;d[3]=a[3]*b;return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opAMulOneF2(outAF2 d,inAF2 a,AF1 b){d[0]=a[0]*b;d[1]=a[1]*b;return d;}
  A_STATIC retAF3 opAMulOneF3(outAF3 d,inAF3 a,AF1 b){d[0]=a[0]*b;d[1]=a[1]*b;d[2]=a[2]*b;return d;}
  A_STATIC retAF4 opAMulOneF4(outAF4 d,inAF4 a,AF1 b){d[0]=a[0]*b;d[1]=a[1]*b;d[2]=a[2]*b;d[3]=a[3]*b;return d;}
+ #endif
 //==============================================================================================================================
  A_STATIC retAD2 opANegD2(outAD2 d,inAD2 a){d[0]=-a[0];d[1]=-a[1];return d;}
  A_STATIC retAD3 opANegD3(outAD3 d,inAD3 a){d[0]=-a[0];d[1]=-a[1];d[2]=-a[2];return d;}
  A_STATIC retAD4 opANegD4(outAD4 d,inAD4 a){d[0]=-a[0];d[1]=-a[1];d[2]=-a[2];d[3]=-a[3];return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opANegF2(outAF2 d,inAF2 a){d[0]=-a[0];d[1]=-a[1];return d;}
  A_STATIC retAF3 opANegF3(outAF3 d,inAF3 a){d[0]=-a[0];d[1]=-a[1];d[2]=-a[2];return d;}
  A_STATIC retAF4 opANegF4(outAF4 d,inAF4 a){d[0]=-a[0];d[1]=-a[1];d[2]=-a[2];d[3]=-a[3];return d;}
+ #endif
 //==============================================================================================================================
  A_STATIC retAD2 opARcpD2(outAD2 d,inAD2 a){d[0]=ARcpD1(a[0]);d[1]=ARcpD1(a[1]);return d;}
  A_STATIC retAD3 opARcpD3(outAD3 d,inAD3 a){d[0]=ARcpD1(a[0]);d[1]=ARcpD1(a[1]);d[2]=ARcpD1(a[2]);return d;}
  A_STATIC retAD4 opARcpD4(outAD4 d,inAD4 a){d[0]=ARcpD1(a[0]);d[1]=ARcpD1(a[1]);d[2]=ARcpD1(a[2]);d[3]=ARcpD1(a[3]);return d;}
 //------------------------------------------------------------------------------------------------------------------------------
+ #if !A_SSE
  A_STATIC retAF2 opARcpF2(outAF2 d,inAF2 a){d[0]=ARcpF1(a[0]);d[1]=ARcpF1(a[1]);return d;}
  A_STATIC retAF3 opARcpF3(outAF3 d,inAF3 a){d[0]=ARcpF1(a[0]);d[1]=ARcpF1(a[1]);d[2]=ARcpF1(a[2]);return d;}
  A_STATIC retAF4 opARcpF4(outAF4 d,inAF4 a){d[0]=ARcpF1(a[0]);d[1]=ARcpF1(a[1]);d[2]=ARcpF1(a[2]);d[3]=ARcpF1(a[3]);return d;}
+ #endif
+//==============================================================================================================================
+ // SSE versions of the float ops above, with the same math and operand order as the A*F1() ops so results match them.
+ // ASseF4 holds an AF2, AF3, or AF4 in a register (unused lanes are 0), to chain ops without going through memory.
+ #ifdef A_CPU_SSE
+  typedef __m128 ASseF4;
+  A_STATIC ASseF4 ASseLdF2(inAF2 a){return _mm_castpd_ps(_mm_load_sd((const double*)a));}
+  A_STATIC ASseF4 ASseLdF3(inAF3 a){return _mm_movelh_ps(ASseLdF2(a),_mm_load_ss(a+2));}
+  A_STATIC ASseF4 ASseLdF4(inAF4 a){return _mm_loadu_ps(a);}
+  A_STATIC ASseF4 ASseOneF4(AF1 a){return _mm_set1_ps(a);}
+  A_STATIC retAF2 ASseStF2(outAF2 d,ASseF4 a){_mm_store_sd((double*)d,_mm_castps_pd(a));return d;}
+  A_STATIC retAF3 ASseStF3(outAF3 d,ASseF4 a){ASseStF2(d,a);_mm_store_ss(d+2,_mm_movehl_ps(a,a));return d;}
+  A_STATIC retAF4 ASseStF4(outAF4 d,ASseF4 a){_mm_storeu_ps(d,a);return d;}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC ASseF4 ASseAbsF4(ASseF4 a){return _mm_and_ps(a,_mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));}
+  A_STATIC ASseF4 ASseAddF4(ASseF4 a,ASseF4 b){return _mm_add_ps(a,b);}
+  A_STATIC ASseF4 ASseNegF4(ASseF4 a){return _mm_xor_ps(a,_mm_set1_ps(-0.0f));}
+  A_STATIC ASseF4 ASseLerpF4(ASseF4 a,ASseF4 b,ASseF4 c){return _mm_add_ps(_mm_mul_ps(b,c),_mm_add_ps(_mm_mul_ps(ASseNegF4(a),c),a));}
+  A_STATIC ASseF4 ASseMaxF4(ASseF4 a,ASseF4 b){return _mm_max_ps(a,b);}
+  A_STATIC ASseF4 ASseMinF4(ASseF4 a,ASseF4 b){return _mm_min_ps(a,b);}
+  A_STATIC ASseF4 ASseMulF4(ASseF4 a,ASseF4 b){return _mm_mul_ps(a,b);}
+  A_STATIC ASseF4 ASseRcpF4(ASseF4 a){return _mm_div_ps(_mm_set1_ps(1.0f),a);}
+//------------------------------------------------------------------------------------------------------------------------------
+  #if A_SSE
+  A_STATIC retAF2 opAAbsF2(outAF2 d,inAF2 a){return ASseStF2(d,ASseAbsF4(ASseLdF2(a)));}
+  A_STATIC retAF3 opAAbsF3(outAF3 d,inAF3 a){return ASseStF3(d,ASseAbsF4(ASseLdF3(a)));}
+  A_STATIC retAF4 opAAbsF4(outAF4 d,inAF4 a){return ASseStF4(d,ASseAbsF4(ASseLdF4(a)));}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC retAF2 opAAddF2(outAF2 d,inAF2 a,inAF2 b){return ASseStF2(d,ASseAddF4(ASseLdF2(a),ASseLdF2(b)));}
+  A_STATIC retAF3 opAAddF3(outAF3 d,inAF3 a,inAF3 b){return ASseStF3(d,ASseAddF4(ASseLdF3(a),ASseLdF3(b)));}
+  A_STATIC retAF4 opAAddF4(outAF4 d,inAF4 a,inAF4 b){return ASseStF4(d,ASseAddF4(ASseLdF4(a),ASseLdF4(b)));}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC retAF2 opACpyF2(outAF2 d,inAF2 a){return ASseStF2(d,ASseLdF2(a));}
+  A_STATIC retAF3 opACpyF3(outAF3 d,inAF3 a){return ASseStF3(d,ASseLdF3(a));}
+  A_STATIC retAF4 opACpyF4(outAF4 d,inAF4 a){return ASseStF4(d,ASseLdF4(a));}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC retAF2 opALerpF2(outAF2 d,inAF2 a,inAF2 b,inAF2 c){return ASseStF2(d,ASseLerpF4(ASseLdF2(a),ASseLdF2(b),ASseLdF2(c)));}
+  A_STATIC retAF3 opALerpF3(outAF3 d,inAF3 a,inAF3 b,inAF3 c){return ASseStF3(d,ASseLerpF4(ASseLdF3(a),ASseLdF3(b),ASseLdF3(c)));}
+  A_STATIC retAF4 opALerpF4(outAF4 d,inAF4 a,inAF4 b,inAF4 c){return ASseStF4(d,ASseLerpF4(ASseLdF4(a),ASseLdF4(b),ASseLdF4(c)));}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC retAF2 opALerpOneF2(outAF2 d,inAF2 a,inAF2 b,AF1 c){return ASseStF2(d,ASseLerpF4(ASseLdF2(a),ASseLdF2(b),ASseOneF4(c)));}
+  A_STATIC retAF3 opALerpOneF3(outAF3 d,inAF3 a,inAF3 b,AF1 c){return ASseStF3(d,ASseLerpF4(ASseLdF3(a),ASseLdF3(b),ASseOneF4(c)));}
+  A_STATIC retAF4 opALerpOneF4(outAF4 d,inAF4 a,inAF4 b,AF1 c){return ASseStF4(d,ASseLerpF4(ASseLdF4(a),ASseLdF4(b),ASseOneF4(c)));}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC retAF2 opAMaxF2(outAF2 d,inAF2 a,inAF2 b){return ASseStF2(d,ASseMaxF4(ASseLdF2(a),ASseLdF2(b)));}
+  A_STATIC retAF3 opAMaxF3(outAF3 d,inAF3 a,inAF3 b){return ASseStF3(d,ASseMaxF4(ASseLdF3(a),ASseLdF3(b)));}
+  A_STATIC retAF4 opAMaxF4(outAF4 d,inAF4 a,inAF4 b){return ASseStF4(d,ASseMaxF4(ASseLdF4(a),ASseLdF4(b)));}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC retAF2 opAMinF2(outAF2 d,inAF2 a,inAF2 b){return ASseStF2(d,ASseMinF4(ASseLdF2(a),ASseLdF2(b)));}
+  A_STATIC retAF3 opAMinF3(outAF3 d,inAF3 a,inAF3 b){return ASseStF3(d,ASseMinF4(ASseLdF3(a),ASseLdF3(b)));}
+  A_STATIC retAF4 opAMinF4(outAF4 d,inAF4 a,inAF4 b){return ASseStF4(d,ASseMinF4(ASseLdF4(a),ASseLdF4(b)));}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC retAF2 opAMulF2(outAF2 d,inAF2 a,inAF2 b){return ASseStF2(d,ASseMulF4(ASseLdF2(a),ASseLdF2(b)));}
+  A_STATIC retAF3 opAMulF3(outAF3 d,inAF3 a,inAF3 b){return ASseStF3(d,ASseMulF4(ASseLdF3(a),ASseLdF3(b)));}
+  A_STATIC retAF4 opAMulF4(outAF4 d,inAF4 a,inAF4 b){return ASseStF4(d,ASseMulF4(ASseLdF4(a),ASseLdF4(b)));}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC retAF2 opAMulOneF2(outAF2 d,inAF2 a,AF1 b){return ASseStF2(d,ASseMulF4(ASseLdF2(a),ASseOneF4(b)));}
+  A_STATIC retAF3 opAMulOneF3(outAF3 d,inAF3 a,AF1 b){return ASseStF3(d,ASseMulF4(ASseLdF3(a),ASseOneF4(b)));}
+  A_STATIC retAF4 opAMulOneF4(outAF4 d,inAF4 a,AF1 b){return ASseStF4(d,ASseMulF4(ASseLdF4(a),ASseOneF4(b)));}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC retAF2 opANegF2(outAF2 d,inAF2 a){return ASseStF2(d,ASseNegF4(ASseLdF2(a)));}
+  A_STATIC retAF3 opANegF3(outAF3 d,inAF3 a){return ASseStF3(d,ASseNegF4(ASseLdF3(a)));}
+  A_STATIC retAF4 opANegF4(outAF4 d,inAF4 a){return ASseStF4(d,ASseNegF4(ASseLdF4(a)));}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_STATIC retAF2 opARcpF2(outAF2 d,inAF2 a){return ASseStF2(d,ASseRcpF4(ASseLdF2(a)));}
+  A_STATIC retAF3 opARcpF3(outAF3 d,inAF3 a){return ASseStF3(d,ASseRcpF4(ASseLdF3(a)));}
+  A_STATIC retAF4 opARcpF4(outAF4 d,inAF4 a){return ASseStF4(d,ASseRcpF4(ASseLdF4(a)));}
+  #endif
+//------------------------------------------------------------------------------------------------------------------------------
+  // The APrx*F1() approximations 4 at a time, same bits as the scalar versions.
+  A_STATIC ASseF4 ASsePrxLoSqrtF4(ASseF4 a){
+   return _mm_castsi128_ps(_mm_add_epi32(_mm_srli_epi32(_mm_castps_si128(a),1),_mm_set1_epi32(0x1fbc4639)));}
+  A_STATIC ASseF4 ASsePrxLoRcpF4(ASseF4 a){return _mm_castsi128_ps(_mm_sub_epi32(_mm_set1_epi32(0x7ef07ebb),_mm_castps_si128(a)));}
+  A_STATIC ASseF4 ASsePrxMedRcpF4(ASseF4 a){
+   ASseF4 b=_mm_castsi128_ps(_mm_sub_epi32(_mm_set1_epi32(0x7ef19fff),_mm_castps_si128(a)));
+   return _mm_mul_ps(b,_mm_add_ps(_mm_mul_ps(ASseNegF4(b),a),_mm_set1_ps(2.0f)));}
+  A_STATIC ASseF4 ASsePrxLoRsqF4(ASseF4 a){
+   return _mm_castsi128_ps(_mm_sub_epi32(_mm_set1_epi32(0x5f347d74),_mm_srli_epi32(_mm_castps_si128(a),1)));}
+ #endif
+//==============================================================================================================================
+ // Same 8 at a time on AVX2.
+ // GCC and Clang build them for AVX2 whatever the compiler targets (A_AVX_FN), for callers which pick AVX2 at runtime.
+ // Only call them from code built for AVX2 as well (such as the AVX2 CPU CAS kernels), or after checking the CPU has it.
+ // Other compilers have them when they target AVX2.
+ // Inlined into code built with FMA, GCC can fuse the Newton-Raphson step of AAvxPrxMedRcpF8(), which changes its rounding.
+ #if defined(A_CPU_SSE)&&defined(A_GCC)&&(defined(__x86_64__)||defined(__i386__))
+  #define A_AVX 1
+  #define A_AVX_FN __attribute__((target("avx2"))) A_STATIC
+ #elif defined(A_CPU_SSE)&&defined(__AVX2__)
+  #define A_AVX 1
+  #define A_AVX_FN A_STATIC
+ #endif
+ #ifdef A_AVX
+  typedef __m256 AAvxF8;
+  A_AVX_FN AAvxF8 AAvxPrxLoSqrtF8(AAvxF8 a){
+   return _mm256_castsi256_ps(_mm256_add_epi32(_mm256_srli_epi32(_mm256_castps_si256(a),1),_mm256_set1_epi32(0x1fbc4639)));}
+  A_AVX_FN AAvxF8 AAvxPrxLoRcpF8(AAvxF8 a){
+   return _mm256_castsi256_ps(_mm256_sub_epi32(_mm256_set1_epi32(0x7ef07ebb),_mm256_castps_si256(a)));}
+  A_AVX_FN AAvxF8 AAvxPrxMedRcpF8(AAvxF8 a){
+   AAvxF8 b=_mm256_castsi256_ps(_mm256_sub_epi32(_mm256_set1_epi32(0x7ef19fff),_mm256_castps_si256(a)));
+   return _mm256_mul_ps(b,_mm256_add_ps(_mm256_mul_ps(_mm256_xor_ps(b,_mm256_set1_ps(-0.0f)),a),_mm256_set1_ps(2.0f)));}
+  A_AVX_FN AAvxF8 AAvxPrxLoRsqF8(AAvxF8 a){
+   return _mm256_castsi256_ps(_mm256_sub_epi32(_mm256_set1_epi32(0x5f347d74),_mm256_srli_epi32(_mm256_castps_si256(a),1)));}
+ #endif
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //_____________________________________________________________/\_______________________________________________________________
@@ -472,77 +675,161 @@
  // Conversion rules are to make computations possibly "safer" on the GPU,
  //  -INF & -NaN -> -65504
  //  +INF & +NaN -> +65504
- A_STATIC AU1 AU1_AH1_AF1(AF1 f){
-  static AW1 base[512]={
-   0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
-   0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
-   0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
-   0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
-   0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
-   0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
-   0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0001,0x0002,0x0004,0x0008,0x0010,0x0020,0x0040,0x0080,0x0100,
-   0x0200,0x0400,0x0800,0x0c00,0x1000,0x1400,0x1800,0x1c00,0x2000,0x2400,0x2800,0x2c00,0x3000,0x3400,0x3800,0x3c00,
-   0x4000,0x4400,0x4800,0x4c00,0x5000,0x5400,0x5800,0x5c00,0x6000,0x6400,0x6800,0x6c00,0x7000,0x7400,0x7800,0x7bff,
-   0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
-   0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
-   0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
-   0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
-   0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
-   0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
-   0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
-   0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
-   0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
-   0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
-   0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
-   0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
-   0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
-   0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8001,0x8002,0x8004,0x8008,0x8010,0x8020,0x8040,0x8080,0x8100,
-   0x8200,0x8400,0x8800,0x8c00,0x9000,0x9400,0x9800,0x9c00,0xa000,0xa400,0xa800,0xac00,0xb000,0xb400,0xb800,0xbc00,
-   0xc000,0xc400,0xc800,0xcc00,0xd000,0xd400,0xd800,0xdc00,0xe000,0xe400,0xe800,0xec00,0xf000,0xf400,0xf800,0xfbff,
-   0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
-   0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
-   0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
-   0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
-   0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
-   0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
-   0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff};
-  static AB1 shift[512]={
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x17,0x16,0x15,0x14,0x13,0x12,0x11,0x10,0x0f,
-   0x0e,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,
-   0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x17,0x16,0x15,0x14,0x13,0x12,0x11,0x10,0x0f,
-   0x0e,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,
-   0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
-   0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18};
-  union{AF1 f;AU1 u;}bits;bits.f=f;AU1 u=bits.u;AU1 i=u>>23;return (AU1)(base[i])+((u&0x7fffff)>>shift[i]);}
+ // Tables indexed by the sign and exponent, at file scope so the conversion can be A_CONSTEXPR.
+ A_STATIC A_CONSTEXPR const AW1 AH1_AF1_Base[512]={
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0001,0x0002,0x0004,0x0008,0x0010,0x0020,0x0040,0x0080,0x0100,
+  0x0200,0x0400,0x0800,0x0c00,0x1000,0x1400,0x1800,0x1c00,0x2000,0x2400,0x2800,0x2c00,0x3000,0x3400,0x3800,0x3c00,
+  0x4000,0x4400,0x4800,0x4c00,0x5000,0x5400,0x5800,0x5c00,0x6000,0x6400,0x6800,0x6c00,0x7000,0x7400,0x7800,0x7bff,
+  0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
+  0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
+  0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
+  0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
+  0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
+  0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
+  0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,0x7bff,
+  0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
+  0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
+  0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
+  0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
+  0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
+  0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,
+  0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8000,0x8001,0x8002,0x8004,0x8008,0x8010,0x8020,0x8040,0x8080,0x8100,
+  0x8200,0x8400,0x8800,0x8c00,0x9000,0x9400,0x9800,0x9c00,0xa000,0xa400,0xa800,0xac00,0xb000,0xb400,0xb800,0xbc00,
+  0xc000,0xc400,0xc800,0xcc00,0xd000,0xd400,0xd800,0xdc00,0xe000,0xe400,0xe800,0xec00,0xf000,0xf400,0xf800,0xfbff,
+  0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
+  0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
+  0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
+  0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
+  0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
+  0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,
+  0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff,0xfbff};
+ A_STATIC A_CONSTEXPR const AB1 AH1_AF1_Shift[512]={
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x17,0x16,0x15,0x14,0x13,0x12,0x11,0x10,0x0f,
+  0x0e,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,
+  0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x17,0x16,0x15,0x14,0x13,0x12,0x11,0x10,0x0f,
+  0x0e,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,
+  0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x0d,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,
+  0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18};
+ A_STATIC A_CONSTEXPR AU1 AU1_AH1_AF1(AF1 f){
+  AU1 u=AU1_AF1(f);AU1 i=u>>23;return (AU1)(AH1_AF1_Base[i])+((u&0x7fffff)>>AH1_AF1_Shift[i]);}
 //------------------------------------------------------------------------------------------------------------------------------
  // Used to output packed constant.
- A_STATIC AU1 AU1_AH2_AF2(inAF2 a){return AU1_AH1_AF1(a[0])+(AU1_AH1_AF1(a[1])<<16);}
+ A_STATIC A_CONSTEXPR AU1 AU1_AH2_AF2(inAF2 a){return AU1_AH1_AF1(a[0])+(AU1_AH1_AF1(a[1])<<16);}
+//------------------------------------------------------------------------------------------------------------------------------
+ // Convert half (in lower 16-bits of input) to float, exact including denormals.
+ // INF stays INF, NaN comes back quiet (like F16C), built from normal floats so it is safe with denormals flushed.
+ A_STATIC A_CONSTEXPR AF1 AF1_AH1_AU1(AU1 h){
+  AU1 em=h&0x7fff;
+  AU1 u=(em<<13)+((127-15)<<23);
+  if(em>=0x7c00){u+=(128-16)<<23;if(em>0x7c00)u|=0x400000;}
+  else if(em<0x0400)u=AU1_AF1(AF1_AU1(u+(1<<23))-AF1_AU1(113<<23));
+  return AF1_AU1(u|((h&0x8000)<<16));}
+//------------------------------------------------------------------------------------------------------------------------------
+ // Whole arrays of halves (as AW1 bits) to and from floats, bit for bit the same as AF1_AH1_AU1() and AU1_AH1_AF1().
+ // On x86 these use F16C (or AVX-512) when the CPU has it.
+ //  - GCC and Clang pick at runtime with __builtin_cpu_supports(), F16C is taken with AVX2 (every AVX2 CPU has it).
+ //  - Other compilers use them when built with /arch:AVX2 (or /arch:AVX512).
+ // F16C keeps INF and NaN, so those (and anything over 65504) are clamped to +/-65504 before the round toward zero.
+ #if defined(A_GCC)&&(defined(__x86_64__)||defined(__i386__))
+  #include <immintrin.h>
+  #define A_CPU_F16C 1
+  #define A_CPU_F16C_FN __attribute__((target("avx2,f16c"))) A_STATIC
+  #define A_CPU_AVX512_FN __attribute__((target("avx512f"))) A_STATIC
+  A_STATIC AU1 AHalfSimd(){return __builtin_cpu_supports("avx512f")?2:(__builtin_cpu_supports("avx2")?1:0);}
+ #elif (defined(_M_X64)||defined(_M_IX86))&&defined(__AVX2__)
+  #include <immintrin.h>
+  #define A_CPU_F16C 1
+  #define A_CPU_F16C_FN A_STATIC
+  #define A_CPU_AVX512_FN A_STATIC
+  #ifdef __AVX512F__
+   A_STATIC AU1 AHalfSimd(){return 2;}
+  #else
+   A_STATIC AU1 AHalfSimd(){return 1;}
+  #endif
+ #endif
+//------------------------------------------------------------------------------------------------------------------------------
+ #ifdef A_CPU_F16C
+  // These return how many elements they did, the caller finishes the rest.
+  A_CPU_F16C_FN AU1 AH1N_AF1N_F16c(AW1*A_RESTRICT d,const AF1*A_RESTRICT s,AU1 n){
+   __m256 abs=_mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)),lim=_mm256_set1_ps(65504.0f);
+   AU1 i=0;
+   for(;i+8<=n;i+=8){
+    __m256 f=_mm256_loadu_ps(s+i);
+    __m256 big=_mm256_cmp_ps(_mm256_and_ps(f,abs),lim,_CMP_NLE_UQ);
+    f=_mm256_blendv_ps(f,_mm256_or_ps(_mm256_andnot_ps(abs,f),lim),big);
+    _mm_storeu_si128((__m128i*)(d+i),_mm256_cvtps_ph(f,_MM_FROUND_TO_ZERO));}
+   return i;}
+  A_CPU_F16C_FN AU1 AF1N_AH1N_F16c(AF1*A_RESTRICT d,const AW1*A_RESTRICT s,AU1 n){
+   AU1 i=0;
+   for(;i+8<=n;i+=8)_mm256_storeu_ps(d+i,_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(s+i))));
+   return i;}
+//------------------------------------------------------------------------------------------------------------------------------
+  A_CPU_AVX512_FN AU1 AH1N_AF1N_Avx512(AW1*A_RESTRICT d,const AF1*A_RESTRICT s,AU1 n){
+   __m512i sgn=_mm512_set1_epi32((int)0x80000000);__m512 lim=_mm512_set1_ps(65504.0f);
+   AU1 i=0;
+   for(;i+16<=n;i+=16){
+    __m512 f=_mm512_loadu_ps(s+i);
+    __mmask16 big=_mm512_cmp_ps_mask(_mm512_abs_ps(f),lim,_CMP_NLE_UQ);
+    __m512 c=_mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(_mm512_castps_si512(f),sgn),_mm512_castps_si512(lim)));
+    _mm256_storeu_si256((__m256i*)(d+i),_mm512_cvtps_ph(_mm512_mask_blend_ps(big,f,c),_MM_FROUND_TO_ZERO));}
+   return i;}
+  A_CPU_AVX512_FN AU1 AF1N_AH1N_Avx512(AF1*A_RESTRICT d,const AW1*A_RESTRICT s,AU1 n){
+   AU1 i=0;
+   for(;i+16<=n;i+=16)_mm512_storeu_ps(d+i,_mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(s+i))));
+   return i;}
+ #endif
+//------------------------------------------------------------------------------------------------------------------------------
+ // Convert 'n' floats in 's' to halves in 'd', see AU1_AH1_AF1() for the rules.
+ A_STATIC void AH1N_AF1N(AW1*A_RESTRICT d,const AF1*A_RESTRICT s,AU1 n){
+  AU1 i=0;
+  #ifdef A_CPU_F16C
+   AU1 simd=AHalfSimd();
+   if(simd==2)i=AH1N_AF1N_Avx512(d,s,n);
+   else if(simd==1)i=AH1N_AF1N_F16c(d,s,n);
+  #endif
+  for(;i<n;i++)d[i]=(AW1)AU1_AH1_AF1(s[i]);}
+//------------------------------------------------------------------------------------------------------------------------------
+ // Convert 'n' halves in 's' to floats in 'd', see AF1_AH1_AU1().
+ A_STATIC void AF1N_AH1N(AF1*A_RESTRICT d,const AW1*A_RESTRICT s,AU1 n){
+  AU1 i=0;
+  #ifdef A_CPU_F16C
+   AU1 simd=AHalfSimd();
+   if(simd==2)i=AF1N_AH1N_Avx512(d,s,n);
+   else if(simd==1)i=AF1N_AH1N_F16c(d,s,n);
+  #endif
+  for(;i<n;i++)d[i]=AF1_AH1_AU1(s[i]);}
 #endif
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1672,6 +1959,7 @@
  #define A_TRUE true
  #define A_FALSE false
  #define A_STATIC
+ #define A_CONSTEXPR
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //_____________________________________________________________/\_______________________________________________________________
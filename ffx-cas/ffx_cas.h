@@ -74,6 +74,9 @@
 // // Later dispatch the shader based on the amount of semi-persistent loop unrolling.
 // // Here is an example for running with the 16x16 (4-way unroll for 32-bit or 2-way unroll for 16-bit)
 // vkCmdDispatch(cmdBuf,(widthInPixels+15)>>4,(heightInPixels+15)>>4,1);
+// ...
+// // Or filter on the CPU instead (see "CPU VERSION" below), here with 32-bit float RGBA images.
+// CasFilterImageCpu(dst,2560*4,2560,1440,src,1920*4,1920,1080,const0,const1,A_FALSE);
 //------------------------------------------------------------------------------------------------------------------------------
 // INTEGRATION SUMMARY FOR GPU
 // ===========================
@@ -338,6 +341,8 @@
 //------------------------------------------------------------------------------------------------------------------------------
 // CHANGE LOG
 // ==========
+// 20261017 - CasSetup() and CasSupportScaling() are A_CONSTEXPR.
+// 20261017 - Added CasFilterCpu() and CasFilterImageCpu(), a scalar CPU port of CasFilter().
 // 20190610 - Misc documentation cleanup.
 // 20190609 - Removed lowQuality bool, improved scaling logic.
 // 20190530 - Unified CPU/GPU setup code, using new ffx_a.h, faster, define CAS_BETTER_DIAGONALS to get older slower one.
@@ -369,10 +374,11 @@
 //------------------------------------------------------------------------------------------------------------------------------
 // Pass in output and input resolution in pixels.
 // This returns true if CAS supports scaling in the given configuration.
-AP1 CasSupportScaling(AF1 outX,AF1 outY,AF1 inX,AF1 inY){return ((outX*outY)*ARcpF1(inX*inY))<=CAS_AREA_LIMIT;}
+A_STATIC A_CONSTEXPR AP1 CasSupportScaling(AF1 outX,AF1 outY,AF1 inX,AF1 inY){return ((outX*outY)*ARcpF1(inX*inY))<=CAS_AREA_LIMIT;}
 //==============================================================================================================================
 // Call to setup required constant values (works on CPU or GPU).
-A_STATIC void CasSetup(
+// On the CPU with A_CONSTEXPR this also works in constant expressions, for sizes fixed at compile time.
+A_STATIC A_CONSTEXPR void CasSetup(
  outAU4 const0,
  outAU4 const1,
  AF1 sharpness, // 0 := default (lower ringing), 1 := maximum (higest ringing)
@@ -1443,3 +1449,230 @@ A_STATIC void CasSetup(
   #endif
  }
 #endif
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                        CPU VERSION
+//------------------------------------------------------------------------------------------------------------------------------
+// Scalar port of CasFilter() for filtering whole images without a GPU.
+// This is the reference which all the faster CPU paths are measured against.
+//  - Source and destination are 32-bit float RGBA, row pitch is in AF1 elements (4*width for a tightly packed image).
+//  - Loads clamp to the image edge.
+//  - Output alpha is copied from the source texel at the integer sample position ('e' no-scaling, 'f' scaling).
+//  - Honors CAS_BETTER_DIAGONALS, CAS_SLOW, CAS_GO_SLOWER, and CAS_DEBUG_CHECKER the same as the GPU version.
+//  - There is no CasInput() hook, input must already be linear.
+//==============================================================================================================================
+#ifdef A_CPU
+ // Returns the address of a clamp-to-edge texel.
+ A_STATIC const AF1* CasTexelCpu(const AF1*A_RESTRICT img,AU1 pitch,AU1 w,AU1 h,ASU1 x,ASU1 y){
+  x=x<0?0:(x>=ASU1_(w)?ASU1_(w)-1:x);
+  y=y<0?0:(y>=ASU1_(h)?ASU1_(h)-1:y);
+  return img+AU1_(y)*pitch+AU1_(x)*AU1_(4);}
+//==============================================================================================================================
+ A_STATIC void CasFilterCpu(
+ outAF4 pix, // Output RGBA.
+ AU1 ipX, // Integer pixel position in output.
+ AU1 ipY,
+ inAU4 const0, // Constants generated by CasSetup().
+ inAU4 const1,
+ AP1 noScaling, // True = sharpen only (no resize).
+ const AF1*A_RESTRICT img, // Source image.
+ AU1 imgPitch,
+ AU1 imgW,
+ AU1 imgH){
+  AU1 k;
+//------------------------------------------------------------------------------------------------------------------------------
+  #ifdef CAS_DEBUG_CHECKER
+   if((((ipX^ipY)>>8u)&1u)==0u){const AF1*e=CasTexelCpu(img,imgPitch,imgW,imgH,ASU1_(ipX),ASU1_(ipY));
+    pix[0]=e[0];pix[1]=e[1];pix[2]=e[2];pix[3]=e[3];return;}
+  #endif
+//------------------------------------------------------------------------------------------------------------------------------
+  // No scaling algorithm uses minimal 3x3 pixel neighborhood.
+  if(noScaling){
+   ASU1 x=ASU1_(ipX),y=ASU1_(ipY);
+   // a b c
+   // d e f
+   // g h i
+   #ifdef CAS_BETTER_DIAGONALS
+    const AF1*a=CasTexelCpu(img,imgPitch,imgW,imgH,x-1,y-1);
+    const AF1*c=CasTexelCpu(img,imgPitch,imgW,imgH,x+1,y-1);
+    const AF1*g=CasTexelCpu(img,imgPitch,imgW,imgH,x-1,y+1);
+    const AF1*i=CasTexelCpu(img,imgPitch,imgW,imgH,x+1,y+1);
+   #endif
+   const AF1*b=CasTexelCpu(img,imgPitch,imgW,imgH,x  ,y-1);
+   const AF1*d=CasTexelCpu(img,imgPitch,imgW,imgH,x-1,y  );
+   const AF1*e=CasTexelCpu(img,imgPitch,imgW,imgH,x  ,y  );
+   const AF1*f=CasTexelCpu(img,imgPitch,imgW,imgH,x+1,y  );
+   const AF1*h=CasTexelCpu(img,imgPitch,imgW,imgH,x  ,y+1);
+   // Per channel, soft min and max, then amount of sharpening and filter weight (see CasFilter() for details).
+   AF1 peak=AF1_AU1(const1[0]);
+   varAF3(wt);
+   for(k=0;k<3;k++){
+    AF1 mn=AMin3F1(AMin3F1(d[k],e[k],f[k]),b[k],h[k]);
+    AF1 mx=AMax3F1(AMax3F1(d[k],e[k],f[k]),b[k],h[k]);
+    #ifdef CAS_BETTER_DIAGONALS
+     mn=mn+AMin3F1(AMin3F1(mn,a[k],c[k]),g[k],i[k]);
+     mx=mx+AMax3F1(AMax3F1(mx,a[k],c[k]),g[k],i[k]);
+     AF1 lim=AF1_(2.0);
+    #else
+     AF1 lim=AF1_(1.0);
+    #endif
+    #ifdef CAS_GO_SLOWER
+     AF1 amp=ASqrtF1(ASatF1(AMinF1(mn,lim-mx)*ARcpF1(mx)));
+    #else
+     AF1 amp=APrxLoSqrtF1(ASatF1(AMinF1(mn,lim-mx)*APrxLoRcpF1(mx)));
+    #endif
+    wt[k]=amp*peak;}
+   // Filter.
+   for(k=0;k<3;k++){
+    #ifndef CAS_SLOW
+     // Using green coef only.
+     AF1 wk=wt[1];
+    #else
+     AF1 wk=wt[k];
+    #endif
+    #ifdef CAS_GO_SLOWER
+     AF1 rcpWeight=ARcpF1(AF1_(1.0)+AF1_(4.0)*wk);
+    #else
+     AF1 rcpWeight=APrxMedRcpF1(AF1_(1.0)+AF1_(4.0)*wk);
+    #endif
+    pix[k]=ASatF1((b[k]*wk+d[k]*wk+f[k]*wk+h[k]*wk+e[k])*rcpWeight);}
+   pix[3]=e[3];
+   return;}
+//------------------------------------------------------------------------------------------------------------------------------
+  // Scaling algorithm adaptively interpolates between nearest 4 results of the non-scaling algorithm.
+  //  a b c d
+  //  e f g h
+  //  i j k l
+  //  m n o p
+  AF1 ppX=AF1_(ipX)*AF1_AU1(const0[0])+AF1_AU1(const0[2]);
+  AF1 ppY=AF1_(ipY)*AF1_AU1(const0[1])+AF1_AU1(const0[3]);
+  AF1 fpX=AFloorF1(ppX);
+  AF1 fpY=AFloorF1(ppY);
+  ppX-=fpX;
+  ppY-=fpY;
+  ASU1 x=ASU1_(fpX),y=ASU1_(fpY);
+  #ifdef CAS_BETTER_DIAGONALS
+   const AF1*a=CasTexelCpu(img,imgPitch,imgW,imgH,x-1,y-1);
+   const AF1*d=CasTexelCpu(img,imgPitch,imgW,imgH,x+2,y-1);
+   const AF1*m=CasTexelCpu(img,imgPitch,imgW,imgH,x-1,y+2);
+   const AF1*p=CasTexelCpu(img,imgPitch,imgW,imgH,x+2,y+2);
+  #endif
+  const AF1*b=CasTexelCpu(img,imgPitch,imgW,imgH,x  ,y-1);
+  const AF1*c=CasTexelCpu(img,imgPitch,imgW,imgH,x+1,y-1);
+  const AF1*e=CasTexelCpu(img,imgPitch,imgW,imgH,x-1,y  );
+  const AF1*f=CasTexelCpu(img,imgPitch,imgW,imgH,x  ,y  );
+  const AF1*g=CasTexelCpu(img,imgPitch,imgW,imgH,x+1,y  );
+  const AF1*h=CasTexelCpu(img,imgPitch,imgW,imgH,x+2,y  );
+  const AF1*i=CasTexelCpu(img,imgPitch,imgW,imgH,x-1,y+1);
+  const AF1*j=CasTexelCpu(img,imgPitch,imgW,imgH,x  ,y+1);
+  const AF1*kk=CasTexelCpu(img,imgPitch,imgW,imgH,x+1,y+1);
+  const AF1*l=CasTexelCpu(img,imgPitch,imgW,imgH,x+2,y+1);
+  const AF1*n=CasTexelCpu(img,imgPitch,imgW,imgH,x  ,y+2);
+  const AF1*o=CasTexelCpu(img,imgPitch,imgW,imgH,x+1,y+2);
+  // Soft min and max for the 4 no-scaling results [F], [G], [J], [K].
+  varAF3(mnf);varAF3(mxf);varAF3(mng);varAF3(mxg);varAF3(mnj);varAF3(mxj);varAF3(mnk);varAF3(mxk);
+  for(k=0;k<3;k++){
+   mnf[k]=AMin3F1(AMin3F1(b[k],e[k],f[k]),g[k],j[k]);
+   mxf[k]=AMax3F1(AMax3F1(b[k],e[k],f[k]),g[k],j[k]);
+   mng[k]=AMin3F1(AMin3F1(c[k],f[k],g[k]),h[k],kk[k]);
+   mxg[k]=AMax3F1(AMax3F1(c[k],f[k],g[k]),h[k],kk[k]);
+   mnj[k]=AMin3F1(AMin3F1(f[k],i[k],j[k]),kk[k],n[k]);
+   mxj[k]=AMax3F1(AMax3F1(f[k],i[k],j[k]),kk[k],n[k]);
+   mnk[k]=AMin3F1(AMin3F1(g[k],j[k],kk[k]),l[k],o[k]);
+   mxk[k]=AMax3F1(AMax3F1(g[k],j[k],kk[k]),l[k],o[k]);
+   #ifdef CAS_BETTER_DIAGONALS
+    mnf[k]=mnf[k]+AMin3F1(AMin3F1(mnf[k],a[k],c[k]),i[k],kk[k]);
+    mxf[k]=mxf[k]+AMax3F1(AMax3F1(mxf[k],a[k],c[k]),i[k],kk[k]);
+    mng[k]=mng[k]+AMin3F1(AMin3F1(mng[k],b[k],d[k]),j[k],l[k]);
+    mxg[k]=mxg[k]+AMax3F1(AMax3F1(mxg[k],b[k],d[k]),j[k],l[k]);
+    mnj[k]=mnj[k]+AMin3F1(AMin3F1(mnj[k],e[k],g[k]),m[k],o[k]);
+    mxj[k]=mxj[k]+AMax3F1(AMax3F1(mxj[k],e[k],g[k]),m[k],o[k]);
+    mnk[k]=mnk[k]+AMin3F1(AMin3F1(mnk[k],f[k],h[k]),n[k],p[k]);
+    mxk[k]=mxk[k]+AMax3F1(AMax3F1(mxk[k],f[k],h[k]),n[k],p[k]);
+   #endif
+  }
+  // Filter shape weights.
+  #ifdef CAS_BETTER_DIAGONALS
+   AF1 lim=AF1_(2.0);
+  #else
+   AF1 lim=AF1_(1.0);
+  #endif
+  AF1 peak=AF1_AU1(const1[0]);
+  varAF3(wf);varAF3(wg);varAF3(wj);varAF3(wk);
+  for(k=0;k<3;k++){
+   #ifdef CAS_GO_SLOWER
+    wf[k]=ASqrtF1(ASatF1(AMinF1(mnf[k],lim-mxf[k])*ARcpF1(mxf[k])))*peak;
+    wg[k]=ASqrtF1(ASatF1(AMinF1(mng[k],lim-mxg[k])*ARcpF1(mxg[k])))*peak;
+    wj[k]=ASqrtF1(ASatF1(AMinF1(mnj[k],lim-mxj[k])*ARcpF1(mxj[k])))*peak;
+    wk[k]=ASqrtF1(ASatF1(AMinF1(mnk[k],lim-mxk[k])*ARcpF1(mxk[k])))*peak;
+   #else
+    wf[k]=APrxLoSqrtF1(ASatF1(AMinF1(mnf[k],lim-mxf[k])*APrxLoRcpF1(mxf[k])))*peak;
+    wg[k]=APrxLoSqrtF1(ASatF1(AMinF1(mng[k],lim-mxg[k])*APrxLoRcpF1(mxg[k])))*peak;
+    wj[k]=APrxLoSqrtF1(ASatF1(AMinF1(mnj[k],lim-mxj[k])*APrxLoRcpF1(mxj[k])))*peak;
+    wk[k]=APrxLoSqrtF1(ASatF1(AMinF1(mnk[k],lim-mxk[k])*APrxLoRcpF1(mxk[k])))*peak;
+   #endif
+  }
+  // Blend between 4 results.
+  //  s t
+  //  u v
+  AF1 s=(AF1_(1.0)-ppX)*(AF1_(1.0)-ppY);
+  AF1 t=           ppX *(AF1_(1.0)-ppY);
+  AF1 u=(AF1_(1.0)-ppX)*           ppY ;
+  AF1 v=           ppX *           ppY ;
+  // Thin edges to hide bilinear interpolation (helps diagonals).
+  AF1 thinB=AF1_(1.0/32.0);
+  #ifdef CAS_GO_SLOWER
+   s*=ARcpF1(thinB+(mxf[1]-mnf[1]));
+   t*=ARcpF1(thinB+(mxg[1]-mng[1]));
+   u*=ARcpF1(thinB+(mxj[1]-mnj[1]));
+   v*=ARcpF1(thinB+(mxk[1]-mnk[1]));
+  #else
+   s*=APrxLoRcpF1(thinB+(mxf[1]-mnf[1]));
+   t*=APrxLoRcpF1(thinB+(mxg[1]-mng[1]));
+   u*=APrxLoRcpF1(thinB+(mxj[1]-mnj[1]));
+   v*=APrxLoRcpF1(thinB+(mxk[1]-mnk[1]));
+  #endif
+  // Final weighting and filter.
+  for(k=0;k<3;k++){
+   #ifndef CAS_SLOW
+    // Using green coef only.
+    AU1 q=1;
+   #else
+    AU1 q=k;
+   #endif
+   AF1 qbe=wf[q]*s;
+   AF1 qch=wg[q]*t;
+   AF1 qf=wg[q]*t+wj[q]*u+s;
+   AF1 qg=wf[q]*s+wk[q]*v+t;
+   AF1 qj=wf[q]*s+wk[q]*v+u;
+   AF1 qk=wg[q]*t+wj[q]*u+v;
+   AF1 qin=wj[q]*u;
+   AF1 qlo=wk[q]*v;
+   #ifdef CAS_GO_SLOWER
+    AF1 rcpW=ARcpF1(AF1_(2.0)*qbe+AF1_(2.0)*qch+AF1_(2.0)*qin+AF1_(2.0)*qlo+qf+qg+qj+qk);
+   #else
+    AF1 rcpW=APrxMedRcpF1(AF1_(2.0)*qbe+AF1_(2.0)*qch+AF1_(2.0)*qin+AF1_(2.0)*qlo+qf+qg+qj+qk);
+   #endif
+   pix[k]=ASatF1((b[k]*qbe+e[k]*qbe+c[k]*qch+h[k]*qch+i[k]*qin+n[k]*qin+l[k]*qlo+o[k]*qlo+
+    f[k]*qf+g[k]*qg+j[k]*qj+kk[k]*qk)*rcpW);}
+  pix[3]=f[3];}
+//==============================================================================================================================
+ // Filter a whole image, use the same 'noScaling' and sizes as were used for CasSetup().
+ A_STATIC void CasFilterImageCpu(
+ AF1*A_RESTRICT dst, // Destination image, 'dstW' by 'dstH' texels.
+ AU1 dstPitch,
+ AU1 dstW,
+ AU1 dstH,
+ const AF1*A_RESTRICT src, // Source image, 'srcW' by 'srcH' texels.
+ AU1 srcPitch,
+ AU1 srcW,
+ AU1 srcH,
+ inAU4 const0,
+ inAU4 const1,
+ AP1 noScaling){
+  AU1 x,y;
+  for(y=0;y<dstH;y++)for(x=0;x<dstW;x++)
+   CasFilterCpu(dst+y*dstPitch+x*AU1_(4),x,y,const0,const1,noScaling,src,srcPitch,srcW,srcH);}
+#endif
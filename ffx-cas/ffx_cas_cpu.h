@@ -0,0 +1,2177 @@
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//
+//                                [CAS] FIDELITY FX - CONSTRAST ADAPTIVE SHARPENING CPU RUNTIME
+//
+//==============================================================================================================================
+// LICENSE
+// =======
+// Copyright (c) 2017-2019 Advanced Micro Devices, Inc. All rights reserved.
+// -------
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// -------
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+// -------
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------------------------------------------------------------
+// ABOUT
+// =====
+// Header-only C++ runtime which runs CAS on the CPU using SIMD.
+// The scalar CasFilterCpu() in 'ffx_cas.h' stays the reference, these paths match it up to FMA rounding.
+// The per instruction set kernels are written once in 'ffx_cas_cpu_kernel.h', which gets included once per target.
+// That happens in 'ffx_cas_cpu_isa.h', which is included once more per compile option variant with CAS_CPU_VARIANTS.
+//------------------------------------------------------------------------------------------------------------------------------
+// INTEGRATION SUMMARY
+// ===================
+// // Make sure <stdint.h> and <math.h> have already been included.
+// #define A_CPU 1
+// // When building with GCC or Clang.
+// #define A_GCC 1
+// #include "ffx_a.h"
+// #include "ffx_cas.h"
+// #include "ffx_cas_cpu.h"
+// ...
+// varAU4(const0);
+// varAU4(const1);
+// CasSetup(const0,const1,0.0f,3840.0f,2160.0f,3840.0f,2160.0f);
+// // Images are 32-bit float RGBA, pitch is in bytes.
+// CasCpuImage src={srcPixels,3840,2160,3840*16};
+// CasCpuImage dst={dstPixels,3840,2160,3840*16};
+// // Or packed half RGBA (R16G16B16A16_FLOAT), half the memory traffic, either side can be either format.
+// CasCpuImage dstH={dstHalfs,3840,2160,3840*8,CAS_CPU_FORMAT_RGBA16F};
+// // Or sRGB encoded (or gamma 2.2, or HDR10 PQ), decoded on load and encoded on store around the linear filter.
+// CasCpuImage srcS={srcBytes,3840,2160,3840*3,CAS_CPU_FORMAT_RGB8};
+// srcS.transfer=CAS_CPU_TRANSFER_SRGB;
+// // HDR10 through scRGB, Rec.2020 results become Rec.709 times maxNits/80 at the store.
+// static const CasCpuMatrixConst scRgb=CasCpuMatrixScRgb(1000.0f);
+// dstH.matrix=&scRgb;
+// // Or your own layout or color transform through Load, Input and Store policies, inlined into the kernels.
+// CasCpuFilterTiledPolicy<CasCpuPolicyRgb10A2,CasCpuInputNone,CasCpuPolicyBgra8>(pool,dst10,src10,const0,const1,A_TRUE);
+// // Or one float plane per channel (alpha optional), read in place by the kernels.
+// CasCpuImage dstP=CasCpuImagePlanar(dstR,dstG,dstB,nullptr,3840,2160,3840*4);
+// // Interleave or deinterleave between any two of these.
+// CasCpuConvert(dst,dstP);
+// // Runs the best kernel the CPU supports (or the one forced with the CAS_CPU_KERNEL environment variable).
+// CasCpuFilter(dst,src,const0,const1,A_TRUE);
+// // Or split into 16x16 tiles across a persistent pool of workers (create the pool once and reuse it).
+// CasCpuPool pool;
+// CasCpuFilterTiled(pool,dst,src,const0,const1,A_TRUE);
+// // Or a whole sequence of same size frames in one call, reporting frames/s.
+// CasCpuBatchStats stats;
+// CasCpuFilterBatch(pool,dstFrames,srcFrames,frameCount,const0,const1,A_TRUE,&stats);
+// // With scaling, build the phase tables once per resolution change, next to CasSetup().
+// CasCpuPhase phase;
+// CasCpuPhaseSetup(phase,const0,3840,2160);
+// CasCpuFilter(dst,srcLow,const0,const1,A_FALSE,&phase);
+// // Or with the sizes fixed at compile time, CasSetup() and the phase tables are done by the compiler.
+// constexpr CasCpuSetupConst k=CasCpuSetup(0.5f,2560.0f,1440.0f,3840.0f,2160.0f);
+// CasCpuFilterFixedTiled<2560,1440,3840,2160>(pool,dst,srcLow,k.const1);
+// // Or pick CAS_BETTER_DIAGONALS, CAS_SLOW and CAS_GO_SLOWER per call, with CAS_CPU_VARIANTS defined to 1 first.
+// CasCpuFilterTiledVariant(pool,dst,src,const0,const1,A_TRUE,CAS_CPU_VARIANT_BETTER_DIAGONALS|CAS_CPU_VARIANT_SLOW);
+// // Or sharpen rows as they arrive, holding only 3 rows.
+// CasCpuStream stream;
+// CasCpuStreamInit(stream,3840,const1);
+// for(...each source row...)if(CasCpuStreamPush(stream,srcRow,dstRow))WriteRow(dstRow);
+// if(CasCpuStreamFinish(stream,dstRow))WriteRow(dstRow);
+// // Or sharpen RGBA8 images (4 bytes per pixel) without converting to float, build the tables once per sharpness.
+// CasCpuFix fix;
+// CasCpuFixSetup(fix,const1);
+// CasCpuFilterRgba8(dst8,src8,fix);
+// // Or sharpen (or upscale, up to CasSupportScaling()) YUV 4:2:0 video on luma alone, with CasSetup() on the luma size.
+// CasCpuY4m y4m;
+// CasCpuYuv in,out;
+// CasCpuY4mReadHeader(fin,y4m);
+// CasCpuY4mWriteHeader(fout,y4m);
+// CasCpuYuvInit(in,y4m.width,y4m.height,y4m.format);
+// CasCpuYuvInit(out,y4m.width,y4m.height,y4m.format);
+// while(CasCpuY4mReadFrame(fin,y4m,in)){
+//  CasCpuFilterYuv(pool,out,in,const0,const1,A_TRUE,y4m.sitX,y4m.sitY);
+//  CasCpuY4mWriteFrame(fout,y4m,out);}
+// // Check what the packed 16-bit CasFilterH() would output (slow, bit exact half arithmetic).
+// CasCpuFilterHTiled(pool,dstH,src,const0,const1,A_TRUE);
+// // Or filter image files in their memory mappings (PFM, PGM, PPM, or raw), with no read or write copies.
+// CasCpuFile fin,fout;
+// CasCpuFileOpen(fin,"in.pfm");
+// CasCpuFileCreate(fout,"out.pfm",CAS_CPU_FILE_PFM,fin.img.width,fin.img.height,fin.img.format);
+// CasCpuFilterTiled(pool,fout.img,fin.img,const0,const1,A_TRUE);
+// CasCpuFileClose(fin);
+// CasCpuFileClose(fout);
+// // Record which kernel ran.
+// printf("CAS kernel: %s\n",CasCpuKernelName(CasCpuKernel()));
+//------------------------------------------------------------------------------------------------------------------------------
+// DATA FLOW
+// =========
+// Work is done a row at a time.
+//  - Source rows get decoded once into planar R,G,B,A float rows, with clamp-to-edge padding on both sides.
+//  - Half sources are widened during that decode (F16C where available), half destinations narrowed at the store.
+//  - One channel (luma) sources decode into the green plane only, and the kernels then run green alone.
+//  - Encoded sources (see "TRANSFER FUNCTIONS") decode to linear there too, encoded destinations encode at the store.
+//  - An output matrix (see "OUTPUT MATRIX") runs on the results in registers just before that encode.
+//  - Planar sources skip the decode where the rows can be read in place, see "PLANAR".
+//  - Decoded rows live in a small cache where the slot is the source row modulo the slot count.
+//  - That is 3 rows for sharpen-only, and 4 rows for scaling (see "SCALING" in 'ffx_cas_cpu_kernel.h').
+//  - With scaling, the source texel and fraction of each output column and row come from the phase tables.
+//  - Kernels then run one vector of output pixels per iteration, taps are unaligned loads from the planar rows.
+//  - Results are interleaved back to RGBA in registers and stored.
+// Compared to gathering 5 interleaved RGBA taps per pixel, this is one transpose per texel in and out.
+//------------------------------------------------------------------------------------------------------------------------------
+// CHANGE LOG
+// ==========
+// 20261017 - Added Load, Input and Store policies, filters built for custom layouts and color transforms.
+// 20261017 - Added the output matrix, for example Rec.2020 to scRGB, run on the results before the store.
+// 20261017 - Added image transfer functions (sRGB, gamma 2.0 and 2.2, PQ) decoded and encoded inside the float kernels.
+// 20261017 - Added CAS_CPU_VARIANTS, all compile option variants of the float kernels in one build.
+// 20261017 - Added filters with the sizes fixed at compile time.
+// 20261017 - Added memory mapped image files, and the R32F and three channel formats.
+// 20261017 - Added planar float images.
+// 20261017 - Added one channel formats and YUV 4:2:0 (Y4M) video.
+// 20261017 - Added batched filtering.
+// 20261017 - Added the packed CasFilterH() emulation.
+// 20261017 - Added RGBA16F images.
+// 20261017 - Added the RGBA8 fixed point kernels.
+// 20261017 - Added scaling phase tables.
+// 20261017 - Added sharpen-only streaming and the portable one lane kernels.
+// 20261017 - Added the thread pool and tiled filtering.
+// 20261017 - Added SSE4.1 kernels and runtime dispatch.
+// 20261017 - Added AVX-512 kernels and the scaling path.
+// 20261017 - Created with the AVX2 sharpen-only kernel.
+//==============================================================================================================================
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#if defined(__x86_64__)||defined(_M_X64)||defined(__i386__)||defined(_M_IX86)
+ #define CAS_CPU_X86 1
+ #include <immintrin.h>
+ #ifdef A_GCC
+  #include <cpuid.h>
+ #else
+  #include <intrin.h>
+ #endif
+#endif
+// Memory mapped files (see "FILES"), on by default where POSIX mmap is available.
+#ifndef CAS_CPU_MMAP
+ #if defined(__unix__)||defined(__APPLE__)
+  #define CAS_CPU_MMAP 1
+ #else
+  #define CAS_CPU_MMAP 0
+ #endif
+#endif
+// Filters with sizes fixed at compile time (see "FIXED SIZE"), on by default when 'ffx_a.h' turned on A_CONSTEXPR.
+// Set it to 0 when defining A_CONSTEXPR empty.
+#ifndef CAS_CPU_FIXED
+ #if defined(A_BIT_CAST)&&(__cplusplus>=201402L)
+  #define CAS_CPU_FIXED 1
+ #else
+  #define CAS_CPU_FIXED 0
+ #endif
+#endif
+// All 8 combinations of CAS_BETTER_DIAGONALS, CAS_SLOW and CAS_GO_SLOWER picked at runtime (see "VARIANTS").
+// Off by default, it builds the kernels 8 more times.
+#ifndef CAS_CPU_VARIANTS
+ #define CAS_CPU_VARIANTS 0
+#endif
+#if CAS_CPU_MMAP
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                         COMMON
+//==============================================================================================================================
+// Padding in AF1 elements on the left of each planar row, also the alignment of the rows.
+#define CAS_CPU_PAD 16
+// Maximum number of cached rows.
+#define CAS_CPU_MAX_ROWS 4
+// Image formats of the float path, computation is always in 32-bit float.
+//  - RGBA32F, 16 bytes per texel.
+//  - RGBA16F, 8 bytes per texel, the R16G16B16A16_FLOAT the samples write, stores round toward zero like AU1_AH1_AF1().
+//  - R8 and R16, one UNORM channel (a video luma plane), filtered as green alone, stores round to nearest.
+//    These only pair with each other, a one channel source has no red, blue, or alpha for an RGBA destination.
+//  - PLANAR32F, one 32-bit float plane per channel in 'planes', 'pitch' is per plane, see "PLANAR" below.
+//  - R32F, one float channel, like R8 and R16 but stored as is.
+//  - RGB32F, RGB8, and RGB16, three channels (UNORM for the integer ones), alpha reads as 1 and is not written.
+//    These are the PFM and PPM layouts, see "FILES" below.
+#define CAS_CPU_FORMAT_RGBA32F 0
+#define CAS_CPU_FORMAT_RGBA16F 1
+#define CAS_CPU_FORMAT_R8 2
+#define CAS_CPU_FORMAT_R16 3
+#define CAS_CPU_FORMAT_PLANAR32F 4
+#define CAS_CPU_FORMAT_R32F 5
+#define CAS_CPU_FORMAT_RGB32F 6
+#define CAS_CPU_FORMAT_RGB8 7
+#define CAS_CPU_FORMAT_RGB16 8
+//------------------------------------------------------------------------------------------------------------------------------
+// Transfer functions of the stored values, the float kernels filter in linear, see "TRANSFER FUNCTIONS" below.
+//  - LINEAR, stored as is.
+//  - SRGB, the piecewise sRGB curve.
+//  - GAMMA2, gamma 2.0, the same curve the RGBA8 fixed point path assumes.
+//  - GAMMA22, gamma 2.2.
+//  - PQ, SMPTE ST 2084 (HDR10), linear 1.0 is 10000 cd/m^2 like AFromPqF1().
+#define CAS_CPU_TRANSFER_LINEAR 0
+#define CAS_CPU_TRANSFER_SRGB 1
+#define CAS_CPU_TRANSFER_GAMMA2 2
+#define CAS_CPU_TRANSFER_GAMMA22 3
+#define CAS_CPU_TRANSFER_PQ 4
+#define CAS_CPU_TRANSFER_COUNT 5
+//------------------------------------------------------------------------------------------------------------------------------
+struct CasCpuMatrixConst;
+//------------------------------------------------------------------------------------------------------------------------------
+// Image view in 'format' (or 8-bit RGBA for the RGBA8 path), 'pitch' is in bytes.
+struct CasCpuImage{
+ void*data;
+ AU1 width;
+ AU1 height;
+ size_t pitch;
+ AU1 format=CAS_CPU_FORMAT_RGBA32F;
+ // Planes {R,G,B,A} of PLANAR32F images ('data' is unused), a null alpha plane reads as 1 and is not written.
+ AF1*planes[4]={};
+ // One of CAS_CPU_TRANSFER_*, for the color channels (alpha is always linear).
+ AU1 transfer=CAS_CPU_TRANSFER_LINEAR;
+ // Color matrix on the results stored to this image, null for none, see "OUTPUT MATRIX".
+ const CasCpuMatrixConst*matrix=nullptr;};
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC inline const AF1* CasCpuRow(const CasCpuImage&img,AU1 y){return (const AF1*)((const char*)img.data+y*img.pitch);}
+A_STATIC inline AF1* CasCpuRowW(const CasCpuImage&img,AU1 y){return (AF1*)((char*)img.data+y*img.pitch);}
+// Bytes per texel, per plane for PLANAR32F.
+A_STATIC inline AU1 CasCpuFormatBytes(AU1 fmt){
+ static const AU1 bytes[]={16u,8u,1u,2u,4u,4u,12u,3u,6u};
+ return bytes[fmt<9u?fmt:0u];}
+// One channel formats, which only decode and filter the green plane.
+A_STATIC inline AP1 CasCpuFormatMono(AU1 fmt){
+ return fmt==CAS_CPU_FORMAT_R8||fmt==CAS_CPU_FORMAT_R16||fmt==CAS_CPU_FORMAT_R32F;}
+A_STATIC inline void* CasCpuTexelW(const CasCpuImage&img,AU1 x,AU1 y){return (char*)CasCpuRowW(img,y)+x*CasCpuFormatBytes(img.format);}
+// The 'row' argument of the texel and kernel functions for texel 'x' of row 'y'.
+// For PLANAR32F that is an array of the 4 plane pointers (null for a missing alpha plane), kept in 'pr'.
+A_STATIC inline void* CasCpuRowAt(const CasCpuImage&img,AU1 x,AU1 y,AF1**pr){
+ if(img.format!=CAS_CPU_FORMAT_PLANAR32F)return CasCpuTexelW(img,x,y);
+ for(AU1 c=0;c<4;c++)pr[c]=img.planes[c]?(AF1*)((char*)img.planes[c]+y*img.pitch)+x:nullptr;
+ return pr;}
+// True if the image has its pixel memory.
+A_STATIC inline AP1 CasCpuImageHasData(const CasCpuImage&img){
+ if(img.format==CAS_CPU_FORMAT_PLANAR32F)return img.planes[0]&&img.planes[1]&&img.planes[2];
+ return img.data!=nullptr;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Texel 'x' of a row in format 'fmt' to and from 4 floats, one channel formats load as {y,y,y,1} and store green.
+A_STATIC inline void CasCpuTexelLd(AF1*A_RESTRICT v,const void*A_RESTRICT row,AU1 fmt,AU1 x){
+ if(fmt==CAS_CPU_FORMAT_RGBA16F){const AW1*p=(const AW1*)row+4*x;for(AU1 c=0;c<4;c++)v[c]=AF1_AH1_AU1(p[c]);}
+ else if(CasCpuFormatMono(fmt)){
+  AF1 y=fmt==CAS_CPU_FORMAT_R8?AF1(((const AB1*)row)[x])*(1.0f/255.0f):(fmt==CAS_CPU_FORMAT_R16?
+   AF1(((const AW1*)row)[x])*(1.0f/65535.0f):((const AF1*)row)[x]);
+  v[0]=v[1]=v[2]=y;v[3]=1.0f;}
+ else if(fmt==CAS_CPU_FORMAT_RGB32F){const AF1*p=(const AF1*)row+3*x;v[0]=p[0];v[1]=p[1];v[2]=p[2];v[3]=1.0f;}
+ else if(fmt==CAS_CPU_FORMAT_RGB8){const AB1*p=(const AB1*)row+3*x;for(AU1 c=0;c<3;c++)v[c]=AF1(p[c])*(1.0f/255.0f);v[3]=1.0f;}
+ else if(fmt==CAS_CPU_FORMAT_RGB16){const AW1*p=(const AW1*)row+3*x;for(AU1 c=0;c<3;c++)v[c]=AF1(p[c])*(1.0f/65535.0f);v[3]=1.0f;}
+ else if(fmt==CAS_CPU_FORMAT_PLANAR32F){
+  const AF1*const*p=(const AF1*const*)row;v[0]=p[0][x];v[1]=p[1][x];v[2]=p[2][x];v[3]=p[3]?p[3][x]:1.0f;}
+ else{const AF1*p=(const AF1*)row+4*x;for(AU1 c=0;c<4;c++)v[c]=p[c];}}
+A_STATIC inline void CasCpuTexelSt(void*A_RESTRICT row,AU1 fmt,AU1 x,const AF1*A_RESTRICT v){
+ if(fmt==CAS_CPU_FORMAT_RGBA16F){AW1*p=(AW1*)row+4*x;for(AU1 c=0;c<4;c++)p[c]=AW1(AU1_AH1_AF1(v[c]));}
+ else if(fmt==CAS_CPU_FORMAT_R8)((AB1*)row)[x]=AB1(ASatF1(v[1])*255.0f+0.5f);
+ else if(fmt==CAS_CPU_FORMAT_R16)((AW1*)row)[x]=AW1(ASatF1(v[1])*65535.0f+0.5f);
+ else if(fmt==CAS_CPU_FORMAT_R32F)((AF1*)row)[x]=v[1];
+ else if(fmt==CAS_CPU_FORMAT_RGB32F){AF1*p=(AF1*)row+3*x;p[0]=v[0];p[1]=v[1];p[2]=v[2];}
+ else if(fmt==CAS_CPU_FORMAT_RGB8){AB1*p=(AB1*)row+3*x;for(AU1 c=0;c<3;c++)p[c]=AB1(ASatF1(v[c])*255.0f+0.5f);}
+ else if(fmt==CAS_CPU_FORMAT_RGB16){AW1*p=(AW1*)row+3*x;for(AU1 c=0;c<3;c++)p[c]=AW1(ASatF1(v[c])*65535.0f+0.5f);}
+ else if(fmt==CAS_CPU_FORMAT_PLANAR32F){
+  AF1*const*p=(AF1*const*)row;p[0][x]=v[0];p[1][x]=v[1];p[2][x]=v[2];if(p[3])p[3][x]=v[3];}
+ else{AF1*p=(AF1*)row+4*x;for(AU1 c=0;c<4;c++)p[c]=v[c];}}
+//------------------------------------------------------------------------------------------------------------------------------
+// Unpacked CasSetup() constants.
+struct CasCpuConst{
+ AF1 scaleX;
+ AF1 scaleY;
+ AF1 offX;
+ AF1 offY;
+ AF1 peak;};
+A_STATIC inline CasCpuConst CasCpuConstUnpack(inAU4 const0,inAU4 const1){
+ CasCpuConst c;
+ c.scaleX=AF1_AU1(const0[0]);c.scaleY=AF1_AU1(const0[1]);c.offX=AF1_AU1(const0[2]);c.offY=AF1_AU1(const0[3]);
+ c.peak=AF1_AU1(const1[0]);
+ return c;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Scaling phase tables, source texel index and fraction of the sample position per output column and per output row.
+// Positions 'i0' to 'i1' along an axis are entries 0 to i1-i0, the same 'pp=ip*scale+off' and floor as the reference.
+// Kept out of line, inlined into the AVX2 and AVX-512 kernels GCC would contract 'pp' into an FMA and shift the fractions.
+#ifdef A_GCC
+ __attribute__((noinline))
+#endif
+A_STATIC inline void CasCpuPhaseAxis(std::vector<ASU1>&ix,std::vector<AF1>&fr,AF1 scale,AF1 off,AU1 i0,AU1 i1){
+ ix.resize(i1-i0);fr.resize(i1-i0);
+ for(AU1 i=i0;i<i1;i++){
+  AF1 pp=AF1(i)*scale+off;
+  AF1 fp=AFloorF1(pp);
+  ix[i-i0]=ASU1(fp);fr[i-i0]=pp-fp;}}
+//------------------------------------------------------------------------------------------------------------------------------
+// Tables cover columns from 'x0' and rows from 'y0', columns run CAS_CPU_PAD past the output for the last vector.
+struct CasCpuPhase{
+ std::vector<ASU1> ix;
+ std::vector<AF1> fx;
+ std::vector<ASU1> iy;
+ std::vector<AF1> fy;
+ AU1 x0;
+ AU1 y0;};
+//------------------------------------------------------------------------------------------------------------------------------
+// Build the tables for output pixels [x0,x1) by [y0,y1), 'const0' is from CasSetup().
+A_STATIC inline void CasCpuPhaseRect(CasCpuPhase&p,inAU4 const0,AU1 x0,AU1 y0,AU1 x1,AU1 y1){
+ CasCpuPhaseAxis(p.ix,p.fx,AF1_AU1(const0[0]),AF1_AU1(const0[2]),x0,x1+CAS_CPU_PAD);
+ CasCpuPhaseAxis(p.iy,p.fy,AF1_AU1(const0[1]),AF1_AU1(const0[3]),y0,y1);
+ p.x0=x0;p.y0=y0;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Build the tables for the whole output once at CasSetup() time, then pass them to the filter calls with scaling.
+A_STATIC inline void CasCpuPhaseSetup(CasCpuPhase&p,inAU4 const0,AU1 outW,AU1 outH){CasCpuPhaseRect(p,const0,0,0,outW,outH);}
+//------------------------------------------------------------------------------------------------------------------------------
+// CasSetup() returning the constants, usable in constant expressions with A_CONSTEXPR.
+struct CasCpuSetupConst{
+ AU1 const0[4];
+ AU1 const1[4];};
+A_STATIC A_CONSTEXPR CasCpuSetupConst CasCpuSetup(AF1 sharpness,AF1 inX,AF1 inY,AF1 outX,AF1 outY){
+ CasCpuSetupConst c={};
+ CasSetup(c.const0,c.const1,sharpness,inX,inY,outX,outY);
+ return c;}
+//------------------------------------------------------------------------------------------------------------------------------
+#if CAS_CPU_FIXED
+ // Floor for the phase tables at compile time, the positions there are well inside the ASU1 range.
+ A_STATIC constexpr AF1 CasCpuFloorC(AF1 a){return AF1(ASU1(a))>a?AF1(ASU1(a))-1.0f:AF1(ASU1(a));}
+ // Entries 0 to n-1 of CasCpuPhaseAxis(), at compile time.
+ A_STATIC A_CONSTEXPR void CasCpuPhaseAxisC(ASU1*ix,AF1*fr,AF1 scale,AF1 off,AU1 n){
+  for(AU1 i=0;i<n;i++){
+   AF1 pp=AF1(i)*scale+off;
+   AF1 fp=CasCpuFloorC(pp);
+   ix[i]=ASU1(fp);fr[i]=pp-fp;}}
+//------------------------------------------------------------------------------------------------------------------------------
+ // CasCpuPhaseSetup() tables of a 'outW' by 'outH' output in arrays, see "FIXED SIZE".
+ template<AU1 outW,AU1 outH> struct CasCpuPhaseFixed{
+  ASU1 ix[outW+CAS_CPU_PAD];
+  AF1 fx[outW+CAS_CPU_PAD];
+  ASU1 iy[outH];
+  AF1 fy[outH];
+  AU1 x0;
+  AU1 y0;};
+ template<AU1 outW,AU1 outH> A_STATIC A_CONSTEXPR CasCpuPhaseFixed<outW,outH> CasCpuPhaseFixedSetup(const CasCpuSetupConst&c){
+  CasCpuPhaseFixed<outW,outH> p={};
+  CasCpuPhaseAxisC(p.ix,p.fx,AF1_AU1(c.const0[0]),AF1_AU1(c.const0[2]),outW+CAS_CPU_PAD);
+  CasCpuPhaseAxisC(p.iy,p.fy,AF1_AU1(c.const0[1]),AF1_AU1(c.const0[3]),outH);
+  return p;}
+//------------------------------------------------------------------------------------------------------------------------------
+ // Filter from 'inW' by 'inH' to 'outW' by 'outH' pixels, everything CasSetup() derives from the sizes as constants.
+ template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> struct CasCpuSize{
+  // The 'const1' here is for sharpness 0, 'const0' only depends on the sizes.
+  static constexpr CasCpuSetupConst setup=CasCpuSetup(0.0f,AF1(inW),AF1(inH),AF1(outW),AF1(outH));
+  static constexpr AP1 noScaling=inW==outW&&inH==outH;
+  static constexpr AF1 scaleX=AF1_AU1(setup.const0[0]);
+  static constexpr AF1 scaleY=AF1_AU1(setup.const0[1]);
+  static constexpr AF1 offX=AF1_AU1(setup.const0[2]);
+  static constexpr AF1 offY=AF1_AU1(setup.const0[3]);
+  // Phase tables in read-only data, only built (by the compiler) when scaling.
+  static const CasCpuPhaseFixed<outW,outH> phase;};
+ template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> constexpr CasCpuSetupConst CasCpuSize<inW,inH,outW,outH>::setup;
+ template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> constexpr AP1 CasCpuSize<inW,inH,outW,outH>::noScaling;
+ template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> constexpr AF1 CasCpuSize<inW,inH,outW,outH>::scaleX;
+ template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> constexpr AF1 CasCpuSize<inW,inH,outW,outH>::scaleY;
+ template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> constexpr AF1 CasCpuSize<inW,inH,outW,outH>::offX;
+ template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> constexpr AF1 CasCpuSize<inW,inH,outW,outH>::offY;
+ template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> constexpr CasCpuPhaseFixed<outW,outH> CasCpuSize<inW,inH,outW,outH>::phase=
+  CasCpuPhaseFixedSetup<outW,outH>(CasCpuSize<inW,inH,outW,outH>::setup);
+#endif
+//------------------------------------------------------------------------------------------------------------------------------
+// Tables for the RGBA8 fixed point kernels, see "RGBA8 FIXED POINT" in 'ffx_cas_cpu_kernel.h'.
+// Linear values are the squared 8-bit codes, the gamma 2.0 approximation, from 0 to CAS_CPU_FIX_ONE.
+#define CAS_CPU_FIX_ONE 65025
+//------------------------------------------------------------------------------------------------------------------------------
+// Table index of 'v', one entry per value below 4096, then one entry per 1<<s values.
+A_STATIC inline AU1 CasCpuFixIdx(AU1 v,AU1 s){return AMinU1(v,4096u)+((AMaxU1(v,4096u)-4096u)>>s);}
+// First value of the range of entry 'i'.
+A_STATIC inline AU1 CasCpuFixVal(AU1 i,AU1 s){return i<4096u?i:4096u+((i-4096u)<<s);}
+// Table index of 'amp' in 8.24, in segments with steps of {1,16,256,4096} keeping the relative step under 1/256.
+A_STATIC inline AU1 CasCpuFixAmpIdx(AU1 v){
+ return AMinU1(v,4096u)+((AMinU1(AMaxU1(v,4096u),65536u)-4096u)>>4)+
+  ((AMinU1(AMaxU1(v,65536u),1048576u)-65536u)>>8)+((AMaxU1(v,1048576u)-1048576u)>>12);}
+// Middle value of the range of entry 'i' of CasCpuFixAmpIdx().
+A_STATIC inline AU1 CasCpuFixAmpVal(AU1 i){
+ if(i<4096u)return i;
+ if(i<7936u)return 4096u+((i-4096u)<<4)+8u;
+ if(i<11776u)return 65536u+((i-7936u)<<8)+128u;
+ return AMinU1(1048576u+((i-11776u)<<12)+2048u,16777216u);}
+//------------------------------------------------------------------------------------------------------------------------------
+struct CasCpuFix{
+ // Pairs of {-wt*rcpWeight in 8.24, rcpWeight*(1+4*wt)-1 in signed 12.20 limited to 1/32}.
+ // Indexed by the min and max codes {max*(max+1)/2+min}, or with CAS_BETTER_DIAGONALS by CasCpuFixAmpIdx(amp).
+ std::vector<AU1> wt;
+ // With CAS_BETTER_DIAGONALS, approximate rcp() of the linear max (0 to 2*CAS_CPU_FIX_ONE).
+ // Scaled so {min*rcp>>4} is 'amp' in 8.24, indexed by CasCpuFixIdx(max,5), entries are for the middle of their range.
+ std::vector<AU1> rcp;
+ // Indexed by CasCpuFixIdx(linear,4), floor(sqrt()) of the first linear value of the range, plus 3 bytes of padding.
+ std::vector<AB1> root;};
+//------------------------------------------------------------------------------------------------------------------------------
+// Weight pair for 'amp' before the sqrt(), the same math as CasFilterCpu().
+A_STATIC inline void CasCpuFixWt(AU1*p,AF1 amp,AF1 peak){
+ #ifdef CAS_GO_SLOWER
+  AF1 w=ASqrtF1(amp)*peak;
+  AF1 rcpWeight=ARcpF1(AF1(1.0)+AF1(4.0)*w);
+ #else
+  AF1 w=APrxLoSqrtF1(amp)*peak;
+  AF1 rcpWeight=APrxMedRcpF1(AF1(1.0)+AF1(4.0)*w);
+ #endif
+ // Output is {e*rcpWeight+(b+d+f+h)*wt*rcpWeight}, which is {e+(4*e-(b+d+f+h))*p[0]+e*p[1]}.
+ double b=-double(w)*double(rcpWeight)*16777216.0+0.5;
+ double e=floor((double(rcpWeight)*(1.0+4.0*double(w))-1.0)*1048576.0+0.5);
+ p[0]=AU1(b<33554431.0?b:33554431.0);
+ p[1]=AU1(ASU1(e<32767.0?(e>-32767.0?e:-32767.0):32767.0));}
+//------------------------------------------------------------------------------------------------------------------------------
+// Build the tables for 'const1' from CasSetup() with equal input and output size.
+A_STATIC inline void CasCpuFixSetup(CasCpuFix&f,inAU4 const1){
+ AF1 peak=AF1_AU1(const1[0]);
+ AU1 one=CAS_CPU_FIX_ONE;
+ #ifdef CAS_BETTER_DIAGONALS
+  f.wt.resize(2*(CasCpuFixAmpIdx(16777216u)+1));
+  for(AU1 i=0;i<f.wt.size()/2;i++)CasCpuFixWt(&f.wt[2*i],AF1(double(CasCpuFixAmpVal(i))*(1.0/16777216.0)),peak);
+  f.rcp.resize(CasCpuFixIdx(2*one,5)+1);
+  for(AU1 i=0;i<f.rcp.size();i++){
+   AU1 v=CasCpuFixVal(i,5);
+   if(i>=4096u)v=AMinU1(v+16u,2*one);
+   if(v==0){f.rcp[i]=0;continue;}
+   #ifdef CAS_GO_SLOWER
+    AF1 r=ARcpF1(AF1(v)/AF1(one));
+   #else
+    AF1 r=APrxLoRcpF1(AF1(v)/AF1(one));
+   #endif
+   f.rcp[i]=AU1(double(r)*(268435456.0/double(one))+0.5);}
+ #else
+  f.wt.resize(256*257);
+  for(AU1 mx=0;mx<256;mx++)for(AU1 mn=0;mn<=mx;mn++){
+   AF1 a=AF1(mn)/AF1(255.0),b=AF1(mx)/AF1(255.0);a*=a;b*=b;
+   #ifdef CAS_GO_SLOWER
+    AF1 amp=ASatF1(AMinF1(a,AF1(1.0)-b)*ARcpF1(b));
+   #else
+    AF1 amp=ASatF1(AMinF1(a,AF1(1.0)-b)*APrxLoRcpF1(b));
+   #endif
+   CasCpuFixWt(&f.wt[2*(mx*(mx+1)/2+mn)],amp,peak);}
+ #endif
+ f.root.resize(CasCpuFixIdx(one,4)+1+3);
+ for(AU1 i=0;i<f.root.size();i++){
+  AU1 v=AMinU1(CasCpuFixVal(i,4),one);
+  AU1 r=AU1(sqrt(double(v)));
+  while(r*r>v)r--;
+  while((r+1)*(r+1)<=v)r++;
+  f.root[i]=AB1(r);}}
+//------------------------------------------------------------------------------------------------------------------------------
+// Cache of decoded planar source rows.
+// Each slot has 4 planes (R,G,B,A), a plane is 'stride' elements, with CAS_CPU_PAD elements ahead of index 0.
+// After the slots is one plane of 1.0, the alpha of PLANAR32F sources without an alpha plane when used in place.
+struct CasCpuRows{
+ std::vector<AF1> mem;
+ AF1*base;
+ size_t stride;
+ AU1 slots;
+ ASU1 tag[CAS_CPU_MAX_ROWS];
+ // Phase tables for rectangles filtered without ones from CasCpuPhaseSetup().
+ CasCpuPhase phase;
+ // Size for 'n' elements per plane (indexes from -CAS_CPU_PAD to n+CAS_CPU_PAD) and 'count' slots, forgets cached rows.
+ void Init(AU1 n,AU1 count){
+  stride=(size_t(n)+3*CAS_CPU_PAD-1)&~size_t(CAS_CPU_PAD-1);
+  slots=count;
+  if(mem.size()<stride*(4*count+1)+CAS_CPU_PAD)mem.resize(stride*(4*count+1)+CAS_CPU_PAD);
+  base=mem.data();while(((size_t)base)&(CAS_CPU_PAD*sizeof(AF1)-1))base++;
+  std::fill(base+stride*4*count,base+stride*(4*count+1),1.0f);
+  Reset();}
+ // Forget cached rows, required whenever the decoded column range changes.
+ void Reset(){for(AU1 i=0;i<CAS_CPU_MAX_ROWS;i++)tag[i]=-1;}
+ AF1* Plane(AU1 slot,AU1 c){return base+(size_t(slot)*4+c)*stride+CAS_CPU_PAD;}
+ AF1* One(){return base+size_t(slots)*4*stride+CAS_CPU_PAD;}};
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                    TRANSFER FUNCTIONS
+//------------------------------------------------------------------------------------------------------------------------------
+// The float kernels convert images with a 'transfer' other than linear on the way in and out, instead of separate passes.
+//  - Sources decode once per texel in the row decode, so the taps and the filter math stay linear.
+//    8-bit and 16-bit UNORM and half sources index tables with the code, which are exact.
+//    Float sources go through the piecewise cubic below.
+//  - Results encode with the piecewise cubic in registers, right before the store converts them to the format.
+//  - Encoded values are in [0,1], float sources outside that are clamped.
+// The cubic has 8 segments per octave from 2^-40 up to 1, picked by the exponent and the top 3 mantissa bits.
+// Each curve is close to a power function within an octave, so the relative error is about the same in every octave.
+// Against the functions in double the largest error is 3e-6 (sRGB encode, next to the linear toe), under a 16-bit code.
+// PQ decode is the exception at 4e-5, where it is steepest near 1, still under a 12-bit code.
+// The RGBA8 fixed point path and the packed emulation ignore 'transfer', the first has gamma 2.0 built in.
+//==============================================================================================================================
+// SMPTE ST 2084 constants.
+#define CAS_CPU_PQ_M1 (2610.0/16384.0)
+#define CAS_CPU_PQ_M2 (2523.0/4096.0*128.0)
+#define CAS_CPU_PQ_C1 (3424.0/4096.0)
+#define CAS_CPU_PQ_C2 (2413.0/4096.0*32.0)
+#define CAS_CPU_PQ_C3 (2392.0/4096.0*32.0)
+//------------------------------------------------------------------------------------------------------------------------------
+// Encoded to linear and back in double, the reference for the tables, values are clamped to [0,1] (NaN to 0).
+A_STATIC inline double CasCpuTransferDecodeD(AU1 t,double x){
+ if(t==CAS_CPU_TRANSFER_LINEAR)return x;
+ x=x>0.0?(x<1.0?x:1.0):0.0;
+ if(t==CAS_CPU_TRANSFER_SRGB)return x<=0.04045?x*(1.0/12.92):pow((x+0.055)*(1.0/1.055),2.4);
+ if(t==CAS_CPU_TRANSFER_GAMMA2)return x*x;
+ if(t==CAS_CPU_TRANSFER_GAMMA22)return pow(x,2.2);
+ double p=pow(x,1.0/CAS_CPU_PQ_M2);
+ return pow((p>CAS_CPU_PQ_C1?p-CAS_CPU_PQ_C1:0.0)/(CAS_CPU_PQ_C2-CAS_CPU_PQ_C3*p),1.0/CAS_CPU_PQ_M1);}
+A_STATIC inline double CasCpuTransferEncodeD(AU1 t,double x){
+ if(t==CAS_CPU_TRANSFER_LINEAR)return x;
+ x=x>0.0?(x<1.0?x:1.0):0.0;
+ if(t==CAS_CPU_TRANSFER_SRGB)return x<=0.0031308?x*12.92:1.055*pow(x,1.0/2.4)-0.055;
+ if(t==CAS_CPU_TRANSFER_GAMMA2)return sqrt(x);
+ if(t==CAS_CPU_TRANSFER_GAMMA22)return pow(x,1.0/2.2);
+ double p=pow(x,CAS_CPU_PQ_M1);
+ return pow((CAS_CPU_PQ_C1+CAS_CPU_PQ_C2*p)/(1.0+CAS_CPU_PQ_C3*p),CAS_CPU_PQ_M2);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Octaves below 1 covered by the cubic, under the first one (2^-40) the result goes linearly to 0.
+// That keeps 0 at 0, which the filter needs for black neighborhoods (PQ encodes 0 as 7e-7 in the reference).
+#define CAS_CPU_CURVE_OCTAVES 40
+#define CAS_CPU_CURVE_MIN (1.0f/1099511627776.0f)
+// Segments, the last one is 1.0 alone.
+#define CAS_CPU_CURVE_SEGS (CAS_CPU_CURVE_OCTAVES*8+1)
+//------------------------------------------------------------------------------------------------------------------------------
+// Coefficients of {c[0]+t*(c[1]+t*(c[2]+t*c[3]))} per segment, one array per power so the kernels can gather them.
+struct CasCpuCurve{
+ AF1 c[4][CAS_CPU_CURVE_SEGS];};
+//------------------------------------------------------------------------------------------------------------------------------
+// Segment of the bits 'u' of a value in [CAS_CPU_CURVE_MIN,1], and the position 't' in [0,1) within it.
+A_STATIC inline AU1 CasCpuCurveSeg(AU1 u){return (u>>20)-((127u-CAS_CPU_CURVE_OCTAVES)<<3);}
+A_STATIC inline AF1 CasCpuCurveT(AU1 u){return AF1_AU1(((u<<3)&0x7fffffu)|0x3f800000u)-1.0f;}
+A_STATIC inline AF1 CasCpuCurveF1(const CasCpuCurve&cv,AF1 x){
+ AU1 u=AU1_AF1(AMinF1(AMaxF1(x,CAS_CPU_CURVE_MIN),1.0f));
+ AU1 s=CasCpuCurveSeg(u);AF1 t=CasCpuCurveT(u);
+ return (cv.c[0][s]+t*(cv.c[1][s]+t*(cv.c[2][s]+t*cv.c[3][s])))*AMinF1(AMaxF1(x*(1.0f/CAS_CPU_CURVE_MIN),0.0f),1.0f);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Fit 'fn' for transfer 't', interpolating each segment at the 4 Chebyshev nodes.
+A_STATIC inline void CasCpuCurveSetup(CasCpuCurve&cv,double(*fn)(AU1,double),AU1 t){
+ double n[4];
+ for(AU1 i=0;i<4;i++)n[i]=0.5-0.5*cos(double(2*i+1)*(3.14159265358979323846/8.0));
+ for(AU1 s=0;s+1<CAS_CPU_CURVE_SEGS;s++){
+  double h=ldexp(1.0/8.0,ASU1(s>>3)-CAS_CPU_CURVE_OCTAVES);
+  double x0=double(8+(s&7u))*h;
+  // Newton divided differences, then expanded to powers of 't'.
+  double d[4];
+  for(AU1 i=0;i<4;i++)d[i]=fn(t,x0+n[i]*h);
+  for(AU1 k=1;k<4;k++)for(AU1 i=3;i>=k;i--)d[i]=(d[i]-d[i-1])/(n[i]-n[i-k]);
+  double c[4]={d[3],0.0,0.0,0.0};
+  for(ASU1 i=2;i>=0;i--){
+   for(AU1 k=3;k>0;k--)c[k]=c[k-1]-n[i]*c[k];
+   c[0]=d[i]-n[i]*c[0];}
+  for(AU1 k=0;k<4;k++)cv.c[k][s]=AF1(c[k]);}
+ cv.c[0][CAS_CPU_CURVE_SEGS-1]=AF1(fn(t,1.0));
+ for(AU1 k=1;k<4;k++)cv.c[k][CAS_CPU_CURVE_SEGS-1]=0.0f;}
+//==============================================================================================================================
+// Everything the kernels need for one transfer.
+struct CasCpuTransfer{
+ // Float sources, and stores.
+ CasCpuCurve dec;
+ CasCpuCurve enc;
+ // Decoded 8-bit and 16-bit UNORM codes, and half bits.
+ AF1 lut8[256];
+ std::vector<AF1> lut16;
+ std::vector<AF1> lutH;};
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC inline void CasCpuTransferSetup(CasCpuTransfer&tf,AU1 t){
+ CasCpuCurveSetup(tf.dec,CasCpuTransferDecodeD,t);
+ CasCpuCurveSetup(tf.enc,CasCpuTransferEncodeD,t);
+ for(AU1 i=0;i<256;i++)tf.lut8[i]=AF1(CasCpuTransferDecodeD(t,double(i)/255.0));
+ tf.lut16.resize(65536);tf.lutH.resize(65536);
+ for(AU1 i=0;i<65536;i++){
+  tf.lut16[i]=AF1(CasCpuTransferDecodeD(t,double(i)/65535.0));
+  tf.lutH[i]=AF1(CasCpuTransferDecodeD(t,double(AF1_AH1_AU1(i))));}}
+//------------------------------------------------------------------------------------------------------------------------------
+// Tables of transfer 't', built on first use, null for linear (and unknown transfers, which are treated as linear).
+A_STATIC const CasCpuTransfer* CasCpuTransferGet(AU1 t){
+ static std::unique_ptr<CasCpuTransfer> tab[CAS_CPU_TRANSFER_COUNT];
+ static std::once_flag once[CAS_CPU_TRANSFER_COUNT];
+ if(t==CAS_CPU_TRANSFER_LINEAR||t>=CAS_CPU_TRANSFER_COUNT)return nullptr;
+ std::call_once(once[t],[t]{tab[t].reset(new CasCpuTransfer);CasCpuTransferSetup(*tab[t],t);});
+ return tab[t].get();}
+//------------------------------------------------------------------------------------------------------------------------------
+// Formats decoded through the tables.
+A_STATIC inline AP1 CasCpuTransferLut(AU1 fmt){
+ return fmt==CAS_CPU_FORMAT_R8||fmt==CAS_CPU_FORMAT_R16||fmt==CAS_CPU_FORMAT_RGB8||fmt==CAS_CPU_FORMAT_RGB16||
+  fmt==CAS_CPU_FORMAT_RGBA16F;}
+//------------------------------------------------------------------------------------------------------------------------------
+// CasCpuTexelLd() decoded with 'tf' (null for linear).
+A_STATIC inline void CasCpuTexelLdT(AF1*A_RESTRICT v,const void*A_RESTRICT row,AU1 fmt,AU1 x,const CasCpuTransfer*tf){
+ CasCpuTexelLd(v,row,fmt,x);
+ if(!tf)return;
+ for(AU1 c=0;c<3;c++){
+  if(fmt==CAS_CPU_FORMAT_R8)v[c]=tf->lut8[((const AB1*)row)[x]];
+  else if(fmt==CAS_CPU_FORMAT_RGB8)v[c]=tf->lut8[((const AB1*)row)[3*x+c]];
+  else if(fmt==CAS_CPU_FORMAT_R16)v[c]=tf->lut16[((const AW1*)row)[x]];
+  else if(fmt==CAS_CPU_FORMAT_RGB16)v[c]=tf->lut16[((const AW1*)row)[3*x+c]];
+  else if(fmt==CAS_CPU_FORMAT_RGBA16F)v[c]=tf->lutH[((const AW1*)row)[4*x+c]];
+  else v[c]=CasCpuCurveF1(tf->dec,v[c]);}}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                      OUTPUT MATRIX
+//------------------------------------------------------------------------------------------------------------------------------
+// The float kernels can run a 3x3 color matrix times a scale on the results, in registers right before the store.
+// That is the "HDR10 output via scRGB" step in 'ffx_cas.h' without a separate pass over the frame:
+//  static const CasCpuMatrixConst m=CasCpuMatrixScRgb(maxNits);
+//  dstH.matrix=&m; // RGBA16F destination, the results are no longer limited to 1.
+//  - It works on the linear results after the saturate, and before the encode of the destination's 'transfer'.
+//  - Alpha passes through, and one channel destinations ignore the matrix.
+//  - The RGBA8 fixed point path, the packed emulation and the streaming API ignore it too.
+// Like CasSetup() the constants are float bits in AU4s, and with A_CONSTEXPR they can be built at compile time.
+//==============================================================================================================================
+// Rows of the matrix with the scale folded in, the last element of each is unused.
+struct CasCpuMatrixConst{
+ AU1 mat0[4];
+ AU1 mat1[4];
+ AU1 mat2[4];};
+//------------------------------------------------------------------------------------------------------------------------------
+// Constants of the row major 3x3 matrix 'm' times 'scale'.
+A_STATIC A_CONSTEXPR void CasCpuMatrixSetup(outAU4 mat0,outAU4 mat1,outAU4 mat2,const AF1*m,AF1 scale){
+ for(AU1 i=0;i<3;i++){
+  mat0[i]=AU1_AF1(m[i]*scale);
+  mat1[i]=AU1_AF1(m[3+i]*scale);
+  mat2[i]=AU1_AF1(m[6+i]*scale);}
+ mat0[3]=mat1[3]=mat2[3]=0u;}
+//------------------------------------------------------------------------------------------------------------------------------
+// CasCpuMatrixSetup() returning the constants.
+A_STATIC A_CONSTEXPR CasCpuMatrixConst CasCpuMatrix(const AF1*m,AF1 scale){
+ CasCpuMatrixConst c={};
+ CasCpuMatrixSetup(c.mat0,c.mat1,c.mat2,m,scale);
+ return c;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Linear Rec.2020 to Rec.709 (sRGB and scRGB) primaries, ITU-R BT.2087, times 'scale'.
+A_STATIC A_CONSTEXPR CasCpuMatrixConst CasCpuMatrixRec2020ToRec709(AF1 scale){
+ const AF1 m[9]={
+   1.660491f,-0.587641f,-0.072850f,
+  -0.124550f, 1.132900f,-0.008349f,
+  -0.018151f,-0.100579f, 1.118730f};
+ return CasCpuMatrix(m,scale);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Rec.2020 with {0 to 1} mapped to {0 to maxNits} nits, to scRGB where 1 is 80 nits.
+A_STATIC A_CONSTEXPR CasCpuMatrixConst CasCpuMatrixScRgb(AF1 maxNits){
+ return CasCpuMatrixRec2020ToRec709(maxNits*(1.0f/80.0f));}
+//==============================================================================================================================
+// What the kernels do to the results of a destination before the store, the matrix then the encode.
+struct CasCpuStore{
+ const CasCpuMatrixConst*matrix;
+ const CasCpuCurve*enc;};
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC inline CasCpuStore CasCpuStoreOf(const CasCpuImage&img){
+ const CasCpuTransfer*tf=CasCpuTransferGet(img.transfer);
+ CasCpuStore st={CasCpuFormatMono(img.format)?nullptr:img.matrix,tf?&tf->enc:nullptr};
+ return st;}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                        KERNELS
+//------------------------------------------------------------------------------------------------------------------------------
+// Each include of 'ffx_cas_cpu_kernel.h' builds the kernels for one instruction set in its own namespace.
+// Those includes are in 'ffx_cas_cpu_isa.h', so "VARIANTS" below can build the whole set again.
+//  - CAS_CPU_ISA selects the vector ops.
+//  - CAS_CPU_FN is the function prefix, on GCC and Clang it carries the target attribute.
+//==============================================================================================================================
+#define CAS_CPU_ISA_SCALAR 0
+#define CAS_CPU_ISA_SSE41 1
+#define CAS_CPU_ISA_AVX2 2
+#define CAS_CPU_ISA_AVX512 3
+//==============================================================================================================================
+#include "ffx_cas_cpu_isa.h"
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                       ENTRY POINTS
+//==============================================================================================================================
+// Filter a whole image, use the same 'noScaling' and sizes as were used for CasSetup().
+// These run one specific kernel, the caller must check that the CPU supports the instruction set.
+// Use CasCpuFilter() below to run the best supported one instead.
+//------------------------------------------------------------------------------------------------------------------------------
+// Images the reference takes, linear RGBA32F on both sides and no output matrix.
+A_STATIC inline AP1 CasCpuReferenceOk(const CasCpuImage&dst,const CasCpuImage&src){
+ return dst.format==CAS_CPU_FORMAT_RGBA32F&&src.format==CAS_CPU_FORMAT_RGBA32F&&
+  dst.transfer==CAS_CPU_TRANSFER_LINEAR&&src.transfer==CAS_CPU_TRANSFER_LINEAR&&!dst.matrix;}
+//------------------------------------------------------------------------------------------------------------------------------
+// The reference CasFilterImageCpu(), other images go through the portable one lane kernel.
+A_STATIC void CasCpuFilterScalar(const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling){
+ if(!CasCpuReferenceOk(dst,src)){
+  CasCpuScalar::CasFilterImage(dst,src,const0,const1,noScaling);return;}
+ CasFilterImageCpu((AF1*)dst.data,AU1(dst.pitch/sizeof(AF1)),dst.width,dst.height,
+  (const AF1*)src.data,AU1(src.pitch/sizeof(AF1)),src.width,src.height,const0,const1,noScaling);}
+//------------------------------------------------------------------------------------------------------------------------------
+// The reference on a rectangle of output pixels [x0,x1) by [y0,y1), the same signature as the kernel's CasFilterRect().
+A_STATIC void CasCpuFilterRectScalar(const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling,
+AU1 x0,AU1 y0,AU1 x1,AU1 y1,CasCpuRows&rows,const CasCpuPhase*phase){
+ if(!CasCpuReferenceOk(dst,src)){
+  CasCpuScalar::CasFilterRect(dst,src,const0,const1,noScaling,x0,y0,x1,y1,rows,phase);return;}
+ for(AU1 y=y0;y<y1;y++)for(AU1 x=x0;x<x1;x++)CasFilterCpu(CasCpuRowW(dst,y)+x*4,x,y,const0,const1,noScaling,
+  (const AF1*)src.data,AU1(src.pitch/sizeof(AF1)),src.width,src.height);}
+//------------------------------------------------------------------------------------------------------------------------------
+#ifdef CAS_CPU_X86
+ // SSE4.1, 4 pixels per iteration.
+ A_STATIC void CasCpuFilterSse41(const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling,
+ const CasCpuPhase*phase=nullptr){
+  CasCpuSse41::CasFilterImage(dst,src,const0,const1,noScaling,phase);}
+ // AVX2, FMA and F16C, 8 pixels per iteration.
+ A_STATIC void CasCpuFilterAvx2(const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling,
+ const CasCpuPhase*phase=nullptr){
+  CasCpuAvx2::CasFilterImage(dst,src,const0,const1,noScaling,phase);}
+ // AVX-512F, 16 pixels per iteration.
+ A_STATIC void CasCpuFilterAvx512(const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling,
+ const CasCpuPhase*phase=nullptr){
+  CasCpuAvx512::CasFilterImage(dst,src,const0,const1,noScaling,phase);}
+#endif
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                        DISPATCH
+//------------------------------------------------------------------------------------------------------------------------------
+// The kernel is picked once, on first use, from what cpuid (and the OS register state from xgetbv) reports.
+// Setting the environment variable CAS_CPU_KERNEL to one of the kernel names forces that kernel instead.
+//  - The forced kernel is only used if the CPU supports it, otherwise the best supported kernel is used.
+//  - CasCpuKernel() returns what is actually bound, log CasCpuKernelName(CasCpuKernel()) to record it.
+// The state lives in function statics, so each translation unit including this header has its own.
+//==============================================================================================================================
+// Kernels in order of preference, each later one implies support for the earlier ones.
+#define CAS_CPU_KERNEL_SCALAR 0
+#define CAS_CPU_KERNEL_SSE41 1
+#define CAS_CPU_KERNEL_AVX2 2
+#define CAS_CPU_KERNEL_AVX512 3
+#define CAS_CPU_KERNEL_COUNT 4
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC const char* CasCpuKernelName(AU1 k){
+ static const char*names[CAS_CPU_KERNEL_COUNT]={"scalar","sse4.1","avx2","avx512"};
+ return k<CAS_CPU_KERNEL_COUNT?names[k]:"unknown";}
+//------------------------------------------------------------------------------------------------------------------------------
+// Returns CAS_CPU_KERNEL_COUNT if the name is unknown.
+A_STATIC AU1 CasCpuKernelFromName(const char*name){
+ if(name==NULL)return CAS_CPU_KERNEL_COUNT;
+ for(AU1 k=0;k<CAS_CPU_KERNEL_COUNT;k++)if(strcmp(name,CasCpuKernelName(k))==0)return k;
+ if(strcmp(name,"sse41")==0)return CAS_CPU_KERNEL_SSE41;
+ return CAS_CPU_KERNEL_COUNT;}
+//==============================================================================================================================
+#ifdef CAS_CPU_X86
+ A_STATIC void CasCpuCpuid(AU1 leaf,AU1 sub,AU1*r){
+  #ifdef A_GCC
+   __cpuid_count(leaf,sub,r[0],r[1],r[2],r[3]);
+  #else
+   int t[4];__cpuidex(t,int(leaf),int(sub));r[0]=AU1(t[0]);r[1]=AU1(t[1]);r[2]=AU1(t[2]);r[3]=AU1(t[3]);
+  #endif
+ }
+//------------------------------------------------------------------------------------------------------------------------------
+ // Low half of XCR0, which register state the OS saves.
+ A_STATIC AU1 CasCpuXcr0(){
+  #ifdef A_GCC
+   AU1 a,d;__asm__ __volatile__("xgetbv":"=a"(a),"=d"(d):"c"(0));(void)d;return a;
+  #else
+   return AU1(_xgetbv(0));
+  #endif
+ }
+#endif
+//------------------------------------------------------------------------------------------------------------------------------
+// Best kernel the CPU and OS support.
+A_STATIC AU1 CasCpuKernelProbe(){
+ #ifdef CAS_CPU_X86
+  AU1 r[4];
+  CasCpuCpuid(0,0,r);
+  AU1 maxLeaf=r[0];
+  CasCpuCpuid(1,0,r);
+  AP1 sse41=((r[2]>>19)&1)!=0;
+  AP1 fma=((r[2]>>12)&1)!=0;
+  AP1 f16c=((r[2]>>29)&1)!=0;
+  AP1 osxsave=((r[2]>>27)&1)!=0;
+  AP1 avx=((r[2]>>28)&1)!=0;
+  // XMM|YMM, and XMM|YMM|OPMASK|ZMM_HI256|HI16_ZMM.
+  AU1 xcr0=osxsave?CasCpuXcr0():0;
+  AP1 osYmm=(xcr0&0x06)==0x06;
+  AP1 osZmm=(xcr0&0xe6)==0xe6;
+  AP1 avx2=false,avx512f=false;
+  if(maxLeaf>=7){CasCpuCpuid(7,0,r);avx2=((r[1]>>5)&1)!=0;avx512f=((r[1]>>16)&1)!=0;}
+  if(avx&&avx2&&fma&&f16c&&osYmm){
+   if(avx512f&&osZmm)return CAS_CPU_KERNEL_AVX512;
+   return CAS_CPU_KERNEL_AVX2;}
+  if(sse41)return CAS_CPU_KERNEL_SSE41;
+ #endif
+ return CAS_CPU_KERNEL_SCALAR;}
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC AU1 CasCpuKernelSupported(){static const AU1 k=CasCpuKernelProbe();return k;}
+//------------------------------------------------------------------------------------------------------------------------------
+// The bound kernel, initialized from CAS_CPU_KERNEL or the probe.
+A_STATIC AU1& CasCpuKernelBound(){
+ static AU1 k=AMinU1(CasCpuKernelFromName(getenv("CAS_CPU_KERNEL")),CasCpuKernelSupported());
+ return k;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Which kernel CasCpuFilter() runs.
+A_STATIC AU1 CasCpuKernel(){return CasCpuKernelBound();}
+//------------------------------------------------------------------------------------------------------------------------------
+// Force a kernel (limited to what is supported), returns the kernel actually bound.
+// Not thread safe against concurrent CasCpuFilter() calls.
+A_STATIC AU1 CasCpuKernelSet(AU1 k){return CasCpuKernelBound()=AMinU1(k,CasCpuKernelSupported());}
+//==============================================================================================================================
+typedef void (*CasCpuRectFn)(const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling,
+ AU1 x0,AU1 y0,AU1 x1,AU1 y1,CasCpuRows&rows,const CasCpuPhase*phase);
+//------------------------------------------------------------------------------------------------------------------------------
+// Rectangle filter function of kernel 'k', the caller must check support.
+A_STATIC CasCpuRectFn CasCpuKernelRect(AU1 k){
+ #ifdef CAS_CPU_X86
+  static const CasCpuRectFn fn[CAS_CPU_KERNEL_COUNT]={CasCpuFilterRectScalar,
+   CasCpuSse41::CasFilterRect,CasCpuAvx2::CasFilterRect,CasCpuAvx512::CasFilterRect};
+  return fn[k<CAS_CPU_KERNEL_COUNT?k:0];
+ #else
+  (void)k;return CasCpuFilterRectScalar;
+ #endif
+ }
+//------------------------------------------------------------------------------------------------------------------------------
+// Filter a whole image with the bound kernel on the calling thread.
+// Use the same 'noScaling' and sizes as were used for CasSetup().
+// With scaling, optional 'phase' tables from CasCpuPhaseSetup() save rebuilding them on each call.
+A_STATIC void CasCpuFilter(const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling,
+const CasCpuPhase*phase=nullptr){
+ CasCpuRows rows;
+ CasCpuKernelRect(CasCpuKernel())(dst,src,const0,const1,noScaling,0,0,dst.width,dst.height,rows,phase);}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                       THREAD POOL
+//------------------------------------------------------------------------------------------------------------------------------
+// Persistent pool running a parallel loop over task indexes, the calling thread is worker 0.
+//  - Each job splits its tasks into one contiguous range per worker.
+//  - A range is a {begin,end} pair packed in one 64-bit atomic.
+//  - Owners pop from the front, idle workers steal the back half of another worker's range.
+//  - Both are a single compare-exchange, so there are no locks while a job runs.
+//  - Completion is a per worker count of finished tasks added to one atomic (once per worker, not per task).
+//  - A worker can still be looking for work when its last job completes, so the next job waits for those to leave first.
+//    Otherwise a late steal from a new range would store its remainder over the worker's own new range, losing tasks.
+// Between jobs workers spin, then yield, then sleep, the mutex and condition variable are only used for sleeping.
+//==============================================================================================================================
+// Spin iterations before yielding, and again before sleeping.
+#ifndef CAS_CPU_SPIN
+ #define CAS_CPU_SPIN 4096
+#endif
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC inline void CasCpuPause(){
+ #ifdef CAS_CPU_X86
+  _mm_pause();
+ #endif
+ }
+//------------------------------------------------------------------------------------------------------------------------------
+typedef void (*CasCpuTaskFn)(void*ctx,AU1 task,AU1 worker);
+//------------------------------------------------------------------------------------------------------------------------------
+class CasCpuPool{
+ public:
+  // Use 0 threads for one worker per hardware thread.
+  explicit CasCpuPool(AU1 threads=0){
+   count=threads?threads:AU1(std::thread::hardware_concurrency());
+   if(count==0)count=1;
+   queues.reset(new Queue[count]);
+   for(AU1 w=0;w<count;w++)queues[w].range.store(0);
+   for(AU1 w=1;w<count;w++)workers.emplace_back(&CasCpuPool::Loop,this,w);}
+//------------------------------------------------------------------------------------------------------------------------------
+  ~CasCpuPool(){
+   quit.store(true);
+   {std::lock_guard<std::mutex> l(m);}
+   cv.notify_all();
+   for(size_t i=0;i<workers.size();i++)workers[i].join();}
+//------------------------------------------------------------------------------------------------------------------------------
+  AU1 Threads()const{return count;}
+//------------------------------------------------------------------------------------------------------------------------------
+  // Run 'fn' for tasks [0,tasks) and wait for all of them, only one thread at a time may call Run().
+  void Run(AU1 tasks,CasCpuTaskFn fn,void*ctx){
+   Job j={fn,ctx};
+   // Close the gate and wait for workers still inside Work(), see Loop().
+   publishing.store(true);
+   for(AU1 spins=0;active.load()!=0;spins++){
+    if(spins<CAS_CPU_SPIN)CasCpuPause();else std::this_thread::yield();}
+   done.store(0,std::memory_order_relaxed);
+   job.store(&j,std::memory_order_release);
+   for(AU1 w=0;w<count;w++)queues[w].range.store(
+    Pack(AU1(uint64_t(tasks)*w/count),AU1(uint64_t(tasks)*(w+1)/count)),std::memory_order_release);
+   epoch.fetch_add(1);
+   publishing.store(false);
+   if(sleepers.load()){{std::lock_guard<std::mutex> l(m);}cv.notify_all();}
+   Work(0);
+   for(AU1 spins=0;done.load(std::memory_order_acquire)<tasks;spins++){
+    if(spins<CAS_CPU_SPIN)CasCpuPause();else std::this_thread::yield();}}
+//------------------------------------------------------------------------------------------------------------------------------
+ private:
+  struct alignas(64) Queue{std::atomic<uint64_t> range;};
+  struct Job{CasCpuTaskFn fn;void*ctx;};
+  AU1 count;
+  std::unique_ptr<Queue[]> queues;
+  std::vector<std::thread> workers;
+  alignas(64) std::atomic<const Job*> job{nullptr};
+  std::atomic<AU1> epoch{0};
+  alignas(64) std::atomic<AU1> done{0};
+  // Workers inside Work(), and set while Run() replaces the ranges.
+  alignas(64) std::atomic<AU1> active{0};
+  std::atomic<bool> publishing{false};
+  alignas(64) std::atomic<AU1> sleepers{0};
+  std::atomic<bool> quit{false};
+  std::mutex m;
+  std::condition_variable cv;
+//------------------------------------------------------------------------------------------------------------------------------
+  static uint64_t Pack(AU1 b,AU1 e){return uint64_t(b)|(uint64_t(e)<<32);}
+//------------------------------------------------------------------------------------------------------------------------------
+  // Take the first task of worker 'w'.
+  AP1 Pop(AU1 w,AU1&t){
+   std::atomic<uint64_t>&q=queues[w].range;
+   uint64_t r=q.load(std::memory_order_acquire);
+   for(;;){
+    AU1 b=AU1(r),e=AU1(r>>32);
+    if(b>=e)return false;
+    if(q.compare_exchange_weak(r,Pack(b+1,e),std::memory_order_acq_rel,std::memory_order_acquire)){t=b;return true;}}}
+//------------------------------------------------------------------------------------------------------------------------------
+  // Take the back half of worker 'v', run the first one as 't' and keep the rest in worker 'w' (which is empty).
+  AP1 Steal(AU1 w,AU1 v,AU1&t){
+   std::atomic<uint64_t>&q=queues[v].range;
+   uint64_t r=q.load(std::memory_order_acquire);
+   for(;;){
+    AU1 b=AU1(r),e=AU1(r>>32);
+    if(b>=e)return false;
+    AU1 h=e-(e-b+1)/2;
+    if(q.compare_exchange_weak(r,Pack(b,h),std::memory_order_acq_rel,std::memory_order_acquire)){
+     t=h;queues[w].range.store(Pack(h+1,e),std::memory_order_release);return true;}}}
+//------------------------------------------------------------------------------------------------------------------------------
+  // Run tasks until there are none left to pop or steal.
+  void Work(AU1 w){
+   AU1 n=0,t;
+   for(;;){
+    if(!Pop(w,t)){
+     AP1 got=false;
+     for(AU1 i=1;i<count&&!got;i++)got=Steal(w,(w+i)%count,t);
+     if(!got)break;}
+    const Job*j=job.load(std::memory_order_acquire);
+    j->fn(j->ctx,t,w);
+    n++;}
+   if(n)done.fetch_add(n,std::memory_order_acq_rel);}
+//------------------------------------------------------------------------------------------------------------------------------
+  void Loop(AU1 w){
+   AU1 seen=0;
+   for(;;){
+    AU1 spins=0;
+    while(epoch.load(std::memory_order_acquire)==seen&&!quit.load(std::memory_order_relaxed)){
+     spins++;
+     if(spins<CAS_CPU_SPIN)CasCpuPause();
+     else if(spins<2*CAS_CPU_SPIN)std::this_thread::yield();
+     else{
+      std::unique_lock<std::mutex> l(m);
+      sleepers.fetch_add(1);
+      cv.wait(l,[&]{return epoch.load()!=seen||quit.load();});
+      sleepers.fetch_sub(1);}}
+    if(quit.load())return;
+    // Enter unless Run() is replacing the ranges, both sides are sequentially consistent so one of them sees the other.
+    active.fetch_add(1);
+    if(publishing.load()){active.fetch_sub(1);CasCpuPause();continue;}
+    seen=epoch.load(std::memory_order_acquire);
+    Work(w);
+    active.fetch_sub(1,std::memory_order_release);}}};
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                         TILES
+//------------------------------------------------------------------------------------------------------------------------------
+// Same decomposition as the GPU dispatch, (width+15)>>4 by (height+15)>>4 tiles of 16x16 output pixels by default.
+// Tiles are numbered in rows, so each worker's initial range is a horizontal band.
+// Wider tiles amortize the per tile decode of the source rows, at the cost of coarser load balancing.
+// Tiles grow past the requested size when there would be more than CasCpuPool::Run() can index.
+//==============================================================================================================================
+// Most tasks one CasCpuPool::Run() can index.
+#define CAS_CPU_TASKS_MAX 0xffffffffu
+//------------------------------------------------------------------------------------------------------------------------------
+// Number of 'tileW' by 'tileH' tiles covering a 'width' by 'height' image, 'tilesX' gets the tiles per row.
+// Tiles are clamped to the image, then doubled (height first) until there are at most 'maxTasks'.
+A_STATIC inline AU1 CasCpuTileCount(AU1&tileW,AU1&tileH,AU1&tilesX,AU1 width,AU1 height,AU1 maxTasks=CAS_CPU_TASKS_MAX){
+ tileW=AMaxU1(AMinU1(tileW,width),1u);
+ tileH=AMaxU1(AMinU1(tileH,height),1u);
+ for(;;){
+  tilesX=AU1((uint64_t(width)+tileW-1)/tileW);
+  uint64_t n=uint64_t(tilesX)*((uint64_t(height)+tileH-1)/tileH);
+  if(n<=maxTasks)return AU1(n);
+  if(tileH<height)tileH=tileH>height/2?height:tileH*2;
+  else tileW=tileW>width/2?width:tileW*2;}}
+//------------------------------------------------------------------------------------------------------------------------------
+struct CasCpuTiles{
+ CasCpuRectFn fn;
+ const CasCpuImage*dst;
+ const CasCpuImage*src;
+ AU1 const0[4];
+ AU1 const1[4];
+ AP1 noScaling;
+ const CasCpuPhase*phase;
+ AU1 tileW;
+ AU1 tileH;
+ AU1 tilesX;};
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC void CasCpuTileTask(void*ctx,AU1 task,AU1 worker){
+ (void)worker;
+ CasCpuTiles&t=*(CasCpuTiles*)ctx;
+ // Per thread row cache, the pool threads are persistent so this is allocated once.
+ static thread_local CasCpuRows rows;
+ AU1 x0=(task%t.tilesX)*t.tileW,y0=(task/t.tilesX)*t.tileH;
+ t.fn(*t.dst,*t.src,t.const0,t.const1,t.noScaling,x0,y0,
+  x0+AMinU1(t.tileW,t.dst->width-x0),y0+AMinU1(t.tileH,t.dst->height-y0),rows,t.phase);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Set up 't' to run 'fn' on 'tileW' by 'tileH' tiles of 'dst' (0 for 16), returns the number of tiles.
+// The tiles grow as in CasCpuTileCount() when there would be more than 'maxTasks'.
+A_STATIC inline AU1 CasCpuTilesInit(CasCpuTiles&t,CasCpuRectFn fn,const CasCpuImage&dst,const CasCpuImage&src,
+const AU1*const0,const AU1*const1,AP1 noScaling,AU1 tileW,AU1 tileH,const CasCpuPhase*phase,
+AU1 maxTasks=CAS_CPU_TASKS_MAX){
+ t.fn=fn;
+ t.dst=&dst;t.src=&src;
+ for(AU1 i=0;i<4;i++){t.const0[i]=const0[i];t.const1[i]=const1[i];}
+ t.noScaling=noScaling;
+ t.phase=phase;
+ t.tileW=tileW?tileW:16;
+ t.tileH=tileH?tileH:16;
+ return CasCpuTileCount(t.tileW,t.tileH,t.tilesX,dst.width,dst.height,maxTasks);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Filter a whole image with the bound kernel across 'pool', in 'tileW' by 'tileH' tiles.
+// Use the same 'noScaling' and sizes as were used for CasSetup().
+// Without 'phase' tables from CasCpuPhaseSetup(), each tile builds its own when scaling.
+A_STATIC void CasCpuFilterTiled(CasCpuPool&pool,const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,
+AP1 noScaling,AU1 tileW=16,AU1 tileH=16,const CasCpuPhase*phase=nullptr){
+ CasCpuTiles t;
+ AU1 n=CasCpuTilesInit(t,CasCpuKernelRect(CasCpuKernel()),dst,src,const0,const1,noScaling,tileW,tileH,phase);
+ pool.Run(n,CasCpuTileTask,&t);}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                        VARIANTS
+//------------------------------------------------------------------------------------------------------------------------------
+// CAS_BETTER_DIAGONALS, CAS_SLOW and CAS_GO_SLOWER normally pick one variant for the whole translation unit.
+// With CAS_CPU_VARIANTS the kernels are built once more per combination, in CasCpuVariant0 to CasCpuVariant7,
+// so quality and speed can be picked per call.
+//  - Each build sees plain #ifdef'ed kernels, only the code of its own options is compiled, as on the GPU.
+//  - Options defined by the includer are saved around the builds and restored after.
+//  - This covers the float kernels (CasCpuFilter() and CasCpuFilterTiled()).
+//    The other paths (streaming, RGBA8, packed, YUV) keep the options of the translation unit.
+//  - The scalar kernel of each variant is the portable one lane kernel, the CasFilterCpu() reference has one variant.
+//==============================================================================================================================
+// Variant bits, OR them together.
+#define CAS_CPU_VARIANT_BETTER_DIAGONALS 1
+#define CAS_CPU_VARIANT_SLOW 2
+#define CAS_CPU_VARIANT_GO_SLOWER 4
+#define CAS_CPU_VARIANT_COUNT 8
+//------------------------------------------------------------------------------------------------------------------------------
+// The variant the rest of this translation unit was built with.
+A_STATIC inline AU1 CasCpuVariantDefault(){
+ AU1 v=0;
+ #ifdef CAS_BETTER_DIAGONALS
+  v|=CAS_CPU_VARIANT_BETTER_DIAGONALS;
+ #endif
+ #ifdef CAS_SLOW
+  v|=CAS_CPU_VARIANT_SLOW;
+ #endif
+ #ifdef CAS_GO_SLOWER
+  v|=CAS_CPU_VARIANT_GO_SLOWER;
+ #endif
+ return v;}
+//==============================================================================================================================
+#if CAS_CPU_VARIANTS
+ #pragma push_macro("CAS_BETTER_DIAGONALS")
+ #pragma push_macro("CAS_SLOW")
+ #pragma push_macro("CAS_GO_SLOWER")
+ #undef CAS_BETTER_DIAGONALS
+ #undef CAS_SLOW
+ #undef CAS_GO_SLOWER
+ // Each step changes one option, in the order {}, {D}, {D,S}, {S}, {S,G}, {D,S,G}, {D,G}, {G}.
+ namespace CasCpuVariant0{
+  #include "ffx_cas_cpu_isa.h"
+ }
+ #define CAS_BETTER_DIAGONALS 1
+ namespace CasCpuVariant1{
+  #include "ffx_cas_cpu_isa.h"
+ }
+ #define CAS_SLOW 1
+ namespace CasCpuVariant3{
+  #include "ffx_cas_cpu_isa.h"
+ }
+ #undef CAS_BETTER_DIAGONALS
+ namespace CasCpuVariant2{
+  #include "ffx_cas_cpu_isa.h"
+ }
+ #define CAS_GO_SLOWER 1
+ namespace CasCpuVariant6{
+  #include "ffx_cas_cpu_isa.h"
+ }
+ #define CAS_BETTER_DIAGONALS 1
+ namespace CasCpuVariant7{
+  #include "ffx_cas_cpu_isa.h"
+ }
+ #undef CAS_SLOW
+ namespace CasCpuVariant5{
+  #include "ffx_cas_cpu_isa.h"
+ }
+ #undef CAS_BETTER_DIAGONALS
+ namespace CasCpuVariant4{
+  #include "ffx_cas_cpu_isa.h"
+ }
+ #undef CAS_GO_SLOWER
+ #pragma pop_macro("CAS_GO_SLOWER")
+ #pragma pop_macro("CAS_SLOW")
+ #pragma pop_macro("CAS_BETTER_DIAGONALS")
+//------------------------------------------------------------------------------------------------------------------------------
+ #ifdef CAS_CPU_X86
+  #define CAS_CPU_VARIANT_RECT(v) {v::CasCpuScalar::CasFilterRect,v::CasCpuSse41::CasFilterRect,\
+   v::CasCpuAvx2::CasFilterRect,v::CasCpuAvx512::CasFilterRect}
+ #else
+  #define CAS_CPU_VARIANT_RECT(v) {v::CasCpuScalar::CasFilterRect}
+ #endif
+ // Rectangle filter function of kernel 'k' for variant 'v' (CAS_CPU_VARIANT_* bits), the caller must check support.
+ A_STATIC CasCpuRectFn CasCpuKernelRectVariant(AU1 k,AU1 v){
+  #ifdef CAS_CPU_X86
+   static const AU1 n=CAS_CPU_KERNEL_COUNT;
+  #else
+   static const AU1 n=1;
+  #endif
+  static const CasCpuRectFn fn[CAS_CPU_VARIANT_COUNT][n]={
+   CAS_CPU_VARIANT_RECT(CasCpuVariant0),CAS_CPU_VARIANT_RECT(CasCpuVariant1),
+   CAS_CPU_VARIANT_RECT(CasCpuVariant2),CAS_CPU_VARIANT_RECT(CasCpuVariant3),
+   CAS_CPU_VARIANT_RECT(CasCpuVariant4),CAS_CPU_VARIANT_RECT(CasCpuVariant5),
+   CAS_CPU_VARIANT_RECT(CasCpuVariant6),CAS_CPU_VARIANT_RECT(CasCpuVariant7)};
+  return fn[v%CAS_CPU_VARIANT_COUNT][k<n?k:0];}
+ #undef CAS_CPU_VARIANT_RECT
+//------------------------------------------------------------------------------------------------------------------------------
+ // CasCpuFilter() with variant 'v'.
+ A_STATIC void CasCpuFilterVariant(const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling,
+ AU1 v,const CasCpuPhase*phase=nullptr){
+  CasCpuRows rows;
+  CasCpuKernelRectVariant(CasCpuKernel(),v)(dst,src,const0,const1,noScaling,0,0,dst.width,dst.height,rows,phase);}
+//------------------------------------------------------------------------------------------------------------------------------
+ // CasCpuFilterTiled() with variant 'v'.
+ A_STATIC void CasCpuFilterTiledVariant(CasCpuPool&pool,const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,
+ inAU4 const1,AP1 noScaling,AU1 v,AU1 tileW=16,AU1 tileH=16,const CasCpuPhase*phase=nullptr){
+  CasCpuTiles t;
+  AU1 n=CasCpuTilesInit(t,CasCpuKernelRectVariant(CasCpuKernel(),v),dst,src,const0,const1,noScaling,tileW,tileH,phase);
+  pool.Run(n,CasCpuTileTask,&t);}
+#endif
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                       FIXED SIZE
+//------------------------------------------------------------------------------------------------------------------------------
+// Filters with the input and output sizes as template arguments, for a resolution fixed at build time (say 1440p to 4K).
+//  - CasSetup() runs at compile time (CasCpuSize), so the scale factors and offsets are constants in the kernels.
+//  - Sharpen-only or scaling follows from the sizes, and only that path is compiled.
+//  - The phase tables are built by the compiler into read-only data, there is no CasCpuPhaseSetup() and no allocation.
+//  - Whether taps are permuted from the window or gathered is resolved too, so the tap fetches are straight-line code.
+// Only 'const1' (the sharpness) is passed at runtime, it can come from CasSetup() or a constexpr CasCpuSetup().
+// The images must have the template sizes.
+// The scalar kernel stays the CasFilterCpu() reference, as in CasCpuFilter().
+// Needs CAS_CPU_FIXED, which follows A_CONSTEXPR (C++14 with a bit cast builtin, see 'ffx_a.h').
+//==============================================================================================================================
+#if CAS_CPU_FIXED
+// Rectangle filter function of kernel 'k' for these sizes, the caller must check support.
+template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> A_STATIC CasCpuRectFn CasCpuKernelRectFixed(AU1 k){
+ #ifdef CAS_CPU_X86
+  static const CasCpuRectFn fn[CAS_CPU_KERNEL_COUNT]={CasCpuFilterRectScalar,
+   CasCpuSse41::CasFilterRectFixed<inW,inH,outW,outH>,CasCpuAvx2::CasFilterRectFixed<inW,inH,outW,outH>,
+   CasCpuAvx512::CasFilterRectFixed<inW,inH,outW,outH>};
+  return fn[k<CAS_CPU_KERNEL_COUNT?k:0];
+ #else
+  (void)k;return CasCpuFilterRectScalar;
+ #endif
+ }
+//------------------------------------------------------------------------------------------------------------------------------
+// Filter a whole image with the bound kernel on the calling thread.
+template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> A_STATIC void CasCpuFilterFixed(const CasCpuImage&dst,const CasCpuImage&src,
+const AU1*const1){
+ typedef CasCpuSize<inW,inH,outW,outH> S;
+ AU1 c0[4],c1[4];
+ for(AU1 i=0;i<4;i++){c0[i]=S::setup.const0[i];c1[i]=const1[i];}
+ CasCpuRows rows;
+ CasCpuKernelRectFixed<inW,inH,outW,outH>(CasCpuKernel())(dst,src,c0,c1,S::noScaling,0,0,outW,outH,rows,nullptr);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Filter a whole image with the bound kernel across 'pool', in 'tileW' by 'tileH' tiles.
+template<AU1 inW,AU1 inH,AU1 outW,AU1 outH> A_STATIC void CasCpuFilterFixedTiled(CasCpuPool&pool,const CasCpuImage&dst,
+const CasCpuImage&src,const AU1*const1,AU1 tileW=16,AU1 tileH=16){
+ typedef CasCpuSize<inW,inH,outW,outH> S;
+ CasCpuTiles t;
+ AU1 n=CasCpuTilesInit(t,CasCpuKernelRectFixed<inW,inH,outW,outH>(CasCpuKernel()),dst,src,S::setup.const0,const1,
+  S::noScaling,tileW,tileH,nullptr);
+ pool.Run(n,CasCpuTileTask,&t);}
+#endif
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                        POLICIES
+//------------------------------------------------------------------------------------------------------------------------------
+// Filters built for a Load, Input and Store policy type, for layouts and color transforms the formats above do not cover.
+//  - Load has 'static void Ld(const void*row,AU1 x,AF1&r,AF1&g,AF1&b,AF1&a)', texel 'x' of a source row.
+//  - Input has 'static void In(AF1&r,AF1&g,AF1&b)', run on each loaded color, like CasInput() on the GPU.
+//  - Store has 'static const AU1 bytes' per texel and 'static void St(void*row,AU1 x,AF1 r,AF1 g,AF1 b,AF1 a)'.
+// The kernels are compiled once per policy triple, so the policy functions inline into the row decode and store loops.
+// Source rows are still decoded once into the planar row cache, and the filter math is unchanged.
+// The image 'format', 'transfer' and 'matrix' are unused, put a transfer function or matrix in the policies instead.
+// The kernels always filter RGB, there is no one channel policy.
+// The scalar kernel is the portable one lane kernel here, as the CasFilterCpu() reference only takes RGBA32F.
+//------------------------------------------------------------------------------------------------------------------------------
+// // R10G10B10A2_UNORM in, swizzled BGRA8 out, with an exposure scale on the input.
+// struct Exposure{static void In(AF1&r,AF1&g,AF1&b){r*=2.0f;g*=2.0f;b*=2.0f;}};
+// CasCpuFilterTiledPolicy<CasCpuPolicyRgb10A2,Exposure,CasCpuPolicyBgra8>(pool,dst,src,const0,const1,A_TRUE);
+//==============================================================================================================================
+// 8-bit UNORM RGBA.
+struct CasCpuPolicyRgba8{
+ static const AU1 bytes=4;
+ static void Ld(const void*A_RESTRICT row,AU1 x,AF1&r,AF1&g,AF1&b,AF1&a){
+  const AB1*p=(const AB1*)row+4*x;
+  r=AF1(p[0])*(1.0f/255.0f);g=AF1(p[1])*(1.0f/255.0f);b=AF1(p[2])*(1.0f/255.0f);a=AF1(p[3])*(1.0f/255.0f);}
+ static void St(void*A_RESTRICT row,AU1 x,AF1 r,AF1 g,AF1 b,AF1 a){
+  AB1*p=(AB1*)row+4*x;
+  p[0]=AB1(ASatF1(r)*255.0f+0.5f);p[1]=AB1(ASatF1(g)*255.0f+0.5f);p[2]=AB1(ASatF1(b)*255.0f+0.5f);
+  p[3]=AB1(ASatF1(a)*255.0f+0.5f);}};
+//------------------------------------------------------------------------------------------------------------------------------
+// 8-bit UNORM BGRA, the usual swap chain and Windows bitmap layout.
+struct CasCpuPolicyBgra8{
+ static const AU1 bytes=4;
+ static void Ld(const void*A_RESTRICT row,AU1 x,AF1&r,AF1&g,AF1&b,AF1&a){CasCpuPolicyRgba8::Ld(row,x,b,g,r,a);}
+ static void St(void*A_RESTRICT row,AU1 x,AF1 r,AF1 g,AF1 b,AF1 a){CasCpuPolicyRgba8::St(row,x,b,g,r,a);}};
+//------------------------------------------------------------------------------------------------------------------------------
+// Half RGBA, stores round toward zero like CAS_CPU_FORMAT_RGBA16F.
+struct CasCpuPolicyRgba16F{
+ static const AU1 bytes=8;
+ static void Ld(const void*A_RESTRICT row,AU1 x,AF1&r,AF1&g,AF1&b,AF1&a){
+  const AW1*p=(const AW1*)row+4*x;
+  r=AF1_AH1_AU1(p[0]);g=AF1_AH1_AU1(p[1]);b=AF1_AH1_AU1(p[2]);a=AF1_AH1_AU1(p[3]);}
+ static void St(void*A_RESTRICT row,AU1 x,AF1 r,AF1 g,AF1 b,AF1 a){
+  AW1*p=(AW1*)row+4*x;
+  p[0]=AW1(AU1_AH1_AF1(r));p[1]=AW1(AU1_AH1_AF1(g));p[2]=AW1(AU1_AH1_AF1(b));p[3]=AW1(AU1_AH1_AF1(a));}};
+//------------------------------------------------------------------------------------------------------------------------------
+// Float RGBA.
+struct CasCpuPolicyRgba32F{
+ static const AU1 bytes=16;
+ static void Ld(const void*A_RESTRICT row,AU1 x,AF1&r,AF1&g,AF1&b,AF1&a){
+  const AF1*p=(const AF1*)row+4*x;r=p[0];g=p[1];b=p[2];a=p[3];}
+ static void St(void*A_RESTRICT row,AU1 x,AF1 r,AF1 g,AF1 b,AF1 a){
+  AF1*p=(AF1*)row+4*x;p[0]=r;p[1]=g;p[2]=b;p[3]=a;}};
+//------------------------------------------------------------------------------------------------------------------------------
+// R10G10B10A2_UNORM, red in the low bits.
+struct CasCpuPolicyRgb10A2{
+ static const AU1 bytes=4;
+ static void Ld(const void*A_RESTRICT row,AU1 x,AF1&r,AF1&g,AF1&b,AF1&a){
+  AU1 u=((const AU1*)row)[x];
+  r=AF1(u&1023u)*(1.0f/1023.0f);g=AF1((u>>10)&1023u)*(1.0f/1023.0f);b=AF1((u>>20)&1023u)*(1.0f/1023.0f);
+  a=AF1(u>>30)*(1.0f/3.0f);}
+ static void St(void*A_RESTRICT row,AU1 x,AF1 r,AF1 g,AF1 b,AF1 a){
+  ((AU1*)row)[x]=AU1(ASatF1(r)*1023.0f+0.5f)|(AU1(ASatF1(g)*1023.0f+0.5f)<<10)|(AU1(ASatF1(b)*1023.0f+0.5f)<<20)|
+   (AU1(ASatF1(a)*3.0f+0.5f)<<30);}};
+//------------------------------------------------------------------------------------------------------------------------------
+// Input policy which leaves the color as loaded.
+struct CasCpuInputNone{static void In(AF1&,AF1&,AF1&){}};
+//==============================================================================================================================
+// Rectangle filter function of kernel 'k' for these policies, the caller must check support.
+template<class L,class I,class S> A_STATIC CasCpuRectFn CasCpuKernelRectPolicy(AU1 k){
+ #ifdef CAS_CPU_X86
+  static const CasCpuRectFn fn[CAS_CPU_KERNEL_COUNT]={CasCpuScalar::CasFilterRectPolicy<L,I,S>,
+   CasCpuSse41::CasFilterRectPolicy<L,I,S>,CasCpuAvx2::CasFilterRectPolicy<L,I,S>,
+   CasCpuAvx512::CasFilterRectPolicy<L,I,S>};
+  return fn[k<CAS_CPU_KERNEL_COUNT?k:0];
+ #else
+  (void)k;return CasCpuScalar::CasFilterRectPolicy<L,I,S>;
+ #endif
+ }
+//------------------------------------------------------------------------------------------------------------------------------
+// Filter a whole image with the bound kernel on the calling thread, as CasCpuFilter().
+template<class L,class I,class S> A_STATIC void CasCpuFilterPolicy(const CasCpuImage&dst,const CasCpuImage&src,
+inAU4 const0,inAU4 const1,AP1 noScaling,const CasCpuPhase*phase=nullptr){
+ CasCpuRows rows;
+ CasCpuKernelRectPolicy<L,I,S>(CasCpuKernel())(dst,src,const0,const1,noScaling,0,0,dst.width,dst.height,rows,phase);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Filter a whole image with the bound kernel across 'pool', in 'tileW' by 'tileH' tiles, as CasCpuFilterTiled().
+template<class L,class I,class S> A_STATIC void CasCpuFilterTiledPolicy(CasCpuPool&pool,const CasCpuImage&dst,
+const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling,AU1 tileW=16,AU1 tileH=16,const CasCpuPhase*phase=nullptr){
+ CasCpuTiles t;
+ AU1 n=CasCpuTilesInit(t,CasCpuKernelRectPolicy<L,I,S>(CasCpuKernel()),dst,src,const0,const1,noScaling,tileW,tileH,phase);
+ pool.Run(n,CasCpuTileTask,&t);}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                         BATCH
+//------------------------------------------------------------------------------------------------------------------------------
+// Filter a sequence of same size frames sharing one 'const0' and 'const1' in a single pool job.
+//  - Images are checked once per batch, scaling phase tables are built once per batch.
+//  - Workers wake once per batch instead of once per frame.
+//  - Frame level runs one frame per task with no tile borders to decode twice, but balances in whole frames.
+//  - Tile level splits every frame into tiles, which balances well but decodes the tile borders twice.
+// CAS_CPU_BATCH_AUTO picks frame level when every worker gets nearly the same number of frames, or frames are small.
+//==============================================================================================================================
+#define CAS_CPU_BATCH_AUTO 0
+#define CAS_CPU_BATCH_FRAMES 1
+#define CAS_CPU_BATCH_TILES 2
+//------------------------------------------------------------------------------------------------------------------------------
+// Frames up to this many pixels are too small to split into tiles.
+#ifndef CAS_CPU_BATCH_SMALL
+ #define CAS_CPU_BATCH_SMALL (256*256)
+#endif
+//------------------------------------------------------------------------------------------------------------------------------
+struct CasCpuBatchStats{
+ AU1 frames;
+ // True if the batch ran one frame per task.
+ AP1 frameLevel;
+ AF1 seconds;
+ AF1 framesPerSecond;};
+//------------------------------------------------------------------------------------------------------------------------------
+// Frame level with 'count' frames of 'pixels' each on 'threads' workers, the last round must be at least 7/8 full.
+A_STATIC inline AP1 CasCpuBatchFrameLevel(AU1 count,AU1 pixels,AU1 threads){
+ if(threads<=1||pixels<=CAS_CPU_BATCH_SMALL)return true;
+ AU1 rounds=(count+threads-1)/threads;
+ return uint64_t(count)*8u>=uint64_t(rounds)*threads*7u;}
+//------------------------------------------------------------------------------------------------------------------------------
+struct CasCpuBatch{
+ CasCpuTiles t;
+ const CasCpuImage*dst;
+ const CasCpuImage*src;
+ AU1 tilesPerFrame;
+ AP1 frameLevel;};
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC void CasCpuBatchTask(void*ctx,AU1 task,AU1 worker){
+ (void)worker;
+ CasCpuBatch&b=*(CasCpuBatch*)ctx;
+ static thread_local CasCpuRows rows;
+ CasCpuTiles&t=b.t;
+ AU1 f=b.frameLevel?task:task/b.tilesPerFrame;
+ const CasCpuImage&dst=b.dst[f];
+ if(b.frameLevel){t.fn(dst,b.src[f],t.const0,t.const1,t.noScaling,0,0,dst.width,dst.height,rows,t.phase);return;}
+ AU1 i=task-f*b.tilesPerFrame;
+ AU1 x0=(i%t.tilesX)*t.tileW,y0=(i/t.tilesX)*t.tileH;
+ t.fn(dst,b.src[f],t.const0,t.const1,t.noScaling,x0,y0,x0+AMinU1(t.tileW,dst.width-x0),y0+AMinU1(t.tileH,dst.height-y0),
+  rows,t.phase);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Filter frames 'src[i]' into 'dst[i]' for 'count' frames with the bound kernel across 'pool'.
+// Use the same 'noScaling' and sizes as were used for CasSetup(), 'mode' is one of CAS_CPU_BATCH_*.
+// All sources must match 'src[0]' and all destinations 'dst[0]' in size and format, otherwise nothing is filtered.
+// Returns false if the images did not check out, 'stats' (optional) gets the aggregate throughput.
+A_STATIC AP1 CasCpuFilterBatch(CasCpuPool&pool,const CasCpuImage*dst,const CasCpuImage*src,AU1 count,
+inAU4 const0,inAU4 const1,AP1 noScaling,CasCpuBatchStats*stats=nullptr,AU1 mode=CAS_CPU_BATCH_AUTO,
+AU1 tileW=16,AU1 tileH=16,const CasCpuPhase*phase=nullptr){
+ auto t0=std::chrono::steady_clock::now();
+ if(stats){stats->frames=0;stats->frameLevel=false;stats->seconds=0.0f;stats->framesPerSecond=0.0f;}
+ if(count==0)return true;
+ const CasCpuImage&d0=dst[0];const CasCpuImage&s0=src[0];
+ if(d0.width==0||d0.height==0||s0.width==0||s0.height==0)return false;
+ if(noScaling&&(d0.width!=s0.width||d0.height!=s0.height))return false;
+ for(AU1 i=0;i<count;i++){
+  const CasCpuImage&d=dst[i];const CasCpuImage&s=src[i];
+  if(!CasCpuImageHasData(d)||!CasCpuImageHasData(s)||d.width!=d0.width||d.height!=d0.height||d.format!=d0.format||
+   s.width!=s0.width||s.height!=s0.height||s.format!=s0.format||
+   d.pitch<size_t(d.width)*CasCpuFormatBytes(d.format)||s.pitch<size_t(s.width)*CasCpuFormatBytes(s.format))return false;}
+ CasCpuPhase batchPhase;
+ if(!noScaling&&!phase){CasCpuPhaseSetup(batchPhase,const0,d0.width,d0.height);phase=&batchPhase;}
+ CasCpuBatch b;
+ b.tilesPerFrame=CasCpuTilesInit(b.t,CasCpuKernelRect(CasCpuKernel()),d0,s0,const0,const1,noScaling,tileW,tileH,phase,
+  CAS_CPU_TASKS_MAX/count);
+ b.dst=dst;b.src=src;
+ b.frameLevel=mode==CAS_CPU_BATCH_FRAMES||
+  (mode==CAS_CPU_BATCH_AUTO&&CasCpuBatchFrameLevel(count,
+  AU1(std::min<uint64_t>(uint64_t(d0.width)*d0.height,0xffffffffu)),pool.Threads()));
+ pool.Run(b.frameLevel?count:count*b.tilesPerFrame,CasCpuBatchTask,&b);
+ if(stats){
+  stats->frames=count;
+  stats->frameLevel=b.frameLevel;
+  stats->seconds=std::chrono::duration<AF1>(std::chrono::steady_clock::now()-t0).count();
+  stats->framesPerSecond=stats->seconds>0.0f?AF1(count)/stats->seconds:0.0f;}
+ return true;}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                       STREAMING
+//------------------------------------------------------------------------------------------------------------------------------
+// Sharpen-only on scanlines as they arrive, for decoders and images too large to hold in memory.
+//  - Push source rows top to bottom, each push after the first writes the output row above the pushed one.
+//  - After the last row call CasCpuStreamFinish() to get the final output row.
+//  - The height does not need to be known up front.
+// Only the 3 decoded rows {y-1,y,y+1} are kept, so memory is O(width).
+// Uses the bound kernel, the reference scalar kernel maps to the portable one lane version of the row kernels.
+//==============================================================================================================================
+struct CasCpuStream{
+ CasCpuRows rows;
+ AU1 width;
+ AF1 peak;
+ AU1 kernel;
+ // Rows pushed in, and rows written out.
+ AU1 in;
+ AU1 out;};
+//------------------------------------------------------------------------------------------------------------------------------
+typedef void (*CasCpuStreamPushFn)(CasCpuRows&rows,const AF1*A_RESTRICT row,AU1 w,AU1 y);
+typedef void (*CasCpuStreamRowFn)(AF1*A_RESTRICT dst,CasCpuRows&rows,AU1 w,AU1 yU,AU1 y,AU1 yD,AF1 peak);
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC void CasCpuStreamKernel(AU1 k,CasCpuStreamPushFn&push,CasCpuStreamRowFn&row){
+ push=CasCpuScalar::CasStreamPush;row=CasCpuScalar::CasStreamRow;
+ #ifdef CAS_CPU_X86
+  if(k==CAS_CPU_KERNEL_SSE41){push=CasCpuSse41::CasStreamPush;row=CasCpuSse41::CasStreamRow;}
+  if(k==CAS_CPU_KERNEL_AVX2){push=CasCpuAvx2::CasStreamPush;row=CasCpuAvx2::CasStreamRow;}
+  if(k==CAS_CPU_KERNEL_AVX512){push=CasCpuAvx512::CasStreamPush;row=CasCpuAvx512::CasStreamRow;}
+ #else
+  (void)k;
+ #endif
+ }
+//------------------------------------------------------------------------------------------------------------------------------
+// Start a stream of 'width' texel wide 32-bit float RGBA rows, 'const1' is from CasSetup() with equal input/output size.
+A_STATIC void CasCpuStreamInit(CasCpuStream&s,AU1 width,inAU4 const1){
+ s.width=width;
+ s.peak=AF1_AU1(const1[0]);
+ s.kernel=CasCpuKernel();
+ s.in=s.out=0;
+ s.rows.Init(width+CAS_CPU_PAD+1,3);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Push the next source row, returns true when output row 's.out-1' was written to 'dst'.
+A_STATIC AP1 CasCpuStreamPush(CasCpuStream&s,const AF1*A_RESTRICT src,AF1*A_RESTRICT dst){
+ CasCpuStreamPushFn push;CasCpuStreamRowFn row;CasCpuStreamKernel(s.kernel,push,row);
+ push(s.rows,src,s.width,s.in);
+ s.in++;
+ if(s.in<2)return false;
+ row(dst,s.rows,s.width,s.out?s.out-1:0,s.out,s.in-1,s.peak);
+ s.out++;
+ return true;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Write the last output row after all source rows were pushed, returns false if nothing was pushed.
+A_STATIC AP1 CasCpuStreamFinish(CasCpuStream&s,AF1*A_RESTRICT dst){
+ if(s.out>=s.in)return false;
+ CasCpuStreamPushFn push;CasCpuStreamRowFn row;CasCpuStreamKernel(s.kernel,push,row);
+ row(dst,s.rows,s.width,s.out?s.out-1:0,s.out,s.out,s.peak);
+ s.out++;
+ return true;}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                         RGBA8
+//------------------------------------------------------------------------------------------------------------------------------
+// Sharpen-only on 8-bit UNORM RGBA images in fixed point, the CasCpuImage views have 4 bytes per pixel.
+// Works as the "UNORM with linear conversion approximation" setup in 'ffx_cas.h', squares on load and sqrt() before store.
+// Tables come from CasCpuFixSetup(), build them once per sharpness change.
+//------------------------------------------------------------------------------------------------------------------------------
+// ERROR BOUND
+// ===========
+// Compared to the float path with the same gamma 2.0 conversion ({(c/255)^2} in, {sqrt(c)*255} rounded out):
+//  - Output codes differ by at most 1, the float result is within 0.56 codes of the fixed point one before rounding.
+//  - With CAS_BETTER_DIAGONALS codes differ by at most 3, only on rare near black pixels next to bright ones,
+//    as 'amp' comes from a bucketed table and its relative error is amplified by sqrt() near black.
+//  - Alpha, and flat areas (where the weights cancel), match exactly.
+// The reference scalar kernel maps to the portable one lane version.
+//==============================================================================================================================
+typedef void (*CasCpuFixRectFn)(const CasCpuImage&dst,const CasCpuImage&src,const CasCpuFix&fix,AU1 x0,AU1 y0,AU1 x1,AU1 y1);
+//------------------------------------------------------------------------------------------------------------------------------
+// RGBA8 rectangle filter function of kernel 'k', the caller must check support.
+A_STATIC CasCpuFixRectFn CasCpuKernelFixRect(AU1 k){
+ #ifdef CAS_CPU_X86
+  static const CasCpuFixRectFn fn[CAS_CPU_KERNEL_COUNT]={CasCpuScalar::CasFixRect,
+   CasCpuSse41::CasFixRect,CasCpuAvx2::CasFixRect,CasCpuAvx512::CasFixRect};
+  return fn[k<CAS_CPU_KERNEL_COUNT?k:0];
+ #else
+  (void)k;return CasCpuScalar::CasFixRect;
+ #endif
+ }
+//------------------------------------------------------------------------------------------------------------------------------
+// Sharpen a whole RGBA8 image with the bound kernel on the calling thread, 'src' and 'dst' must be the same size.
+A_STATIC void CasCpuFilterRgba8(const CasCpuImage&dst,const CasCpuImage&src,const CasCpuFix&fix){
+ CasCpuKernelFixRect(CasCpuKernel())(dst,src,fix,0,0,dst.width,dst.height);}
+//==============================================================================================================================
+struct CasCpuFixTiles{
+ CasCpuFixRectFn fn;
+ const CasCpuImage*dst;
+ const CasCpuImage*src;
+ const CasCpuFix*fix;
+ AU1 tileW;
+ AU1 tileH;
+ AU1 tilesX;};
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC void CasCpuFixTileTask(void*ctx,AU1 task,AU1 worker){
+ (void)worker;
+ CasCpuFixTiles&t=*(CasCpuFixTiles*)ctx;
+ AU1 x0=(task%t.tilesX)*t.tileW,y0=(task/t.tilesX)*t.tileH;
+ t.fn(*t.dst,*t.src,*t.fix,x0,y0,x0+AMinU1(t.tileW,t.dst->width-x0),y0+AMinU1(t.tileH,t.dst->height-y0));}
+//------------------------------------------------------------------------------------------------------------------------------
+// Sharpen a whole RGBA8 image with the bound kernel across 'pool', in 'tileW' by 'tileH' tiles.
+// There is no per tile decode, so tiles can be small without extra cost.
+A_STATIC void CasCpuFilterRgba8Tiled(CasCpuPool&pool,const CasCpuImage&dst,const CasCpuImage&src,const CasCpuFix&fix,
+AU1 tileW=64,AU1 tileH=16){
+ CasCpuFixTiles t;
+ t.fn=CasCpuKernelFixRect(CasCpuKernel());
+ t.dst=&dst;t.src=&src;t.fix=&fix;
+ t.tileW=tileW?tileW:64;
+ t.tileH=tileH?tileH:16;
+ pool.Run(CasCpuTileCount(t.tileW,t.tileH,t.tilesX,dst.width,dst.height),CasCpuFixTileTask,&t);}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                    PACKED EMULATION
+//------------------------------------------------------------------------------------------------------------------------------
+// Scalar emulation of the packed 16-bit CasFilterH(), to check packed mode output offline.
+//  - Every half op is done in float then rounded to nearest even, with FP16 denormals and overflow to infinity.
+//    Float has more than 2*11+2 significand bits, so this double rounding is exact for add, mul, div and sqrt.
+//  - Ops are not fused, each one rounds in the order written in CasFilterH().
+//  - The APrx*H2() approximations run on the 16-bit patterns, APrxLo*H1() from 'ffx_a.h' and the 0x778d constant of APrxMedRcpH1().
+//  - Taps are the source converted to half (exact for RGBA16F sources), loads clamp to the image edge.
+//  - With scaling, pixels 8 to 15 of each 16 wide group are the second lane of the pixel 8 to the left,
+//    so their position comes from adding 'const1.z' like the shader does.
+//  - Peak is the packed half in 'const1.y'.
+//  - Output alpha is the source alpha at the integer sample position, converted to half.
+// This follows the GLSL path, HLSL forces CAS_GO_SLOWER for CasFilterH(), so define it to match the DX12 sample.
+// With CAS_GO_SLOWER rcp() and sqrt() are correctly rounded, hardware may differ there.
+//==============================================================================================================================
+// Round to the nearest half, returned as float.
+A_STATIC inline AF1 CasCpuHRnd(AF1 x){
+ AU1 u=AU1_AF1(x);AU1 a=u&0x7fffffffu;
+ // Denormal range, adding 0.5 rounds to a multiple of 2^-24.
+ if(a<0x38800000u){AF1 f=AF1_AU1(a)+0.5f;f-=0.5f;return AF1_AU1(AU1_AF1(f)|(u&0x80000000u));}
+ if(a>=0x7f800000u)return x;
+ a=(a+0x0fffu+((a>>13)&1u))&~0x1fffu;
+ if(a>0x477fe000u)a=0x7f800000u;
+ return AF1_AU1(a|(u&0x80000000u));}
+//------------------------------------------------------------------------------------------------------------------------------
+// Bits of a float holding an exact half.
+A_STATIC inline AU1 CasCpuHBits(AF1 h){
+ AU1 u=AU1_AF1(h);AU1 a=u&0x7fffffffu;AU1 s=(u>>16)&0x8000u;
+ if(a<0x38800000u)return s|AU1(AF1_AU1(a)*16777216.0f);
+ if(a>=0x7f800000u)return s|0x7c00u|((a&0x7fffffu)?0x200u:0u);
+ return s|((a>>13)-((127u-15u)<<10));}
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC inline AF1 CasCpuHAdd(AF1 a,AF1 b){return CasCpuHRnd(a+b);}
+A_STATIC inline AF1 CasCpuHSub(AF1 a,AF1 b){return CasCpuHRnd(a-b);}
+A_STATIC inline AF1 CasCpuHMul(AF1 a,AF1 b){return CasCpuHRnd(a*b);}
+A_STATIC inline AF1 CasCpuHSat(AF1 a){return AMinF1(AMaxF1(a,0.0f),1.0f);}
+A_STATIC inline AF1 CasCpuHMin3(AF1 a,AF1 b,AF1 c){return AMinF1(a,AMinF1(b,c));}
+A_STATIC inline AF1 CasCpuHMax3(AF1 a,AF1 b,AF1 c){return AMaxF1(a,AMaxF1(b,c));}
+A_STATIC inline AF1 CasCpuHAmpRcp(AF1 a){
+ #ifdef CAS_GO_SLOWER
+  return CasCpuHRnd(ARcpF1(a));
+ #else
+  return AF1_AH1_AU1(APrxLoRcpH1(CasCpuHBits(a)));
+ #endif
+ }
+A_STATIC inline AF1 CasCpuHAmpSqrt(AF1 a){
+ #ifdef CAS_GO_SLOWER
+  return CasCpuHRnd(ASqrtF1(a));
+ #else
+  return AF1_AH1_AU1(APrxLoSqrtH1(CasCpuHBits(a)));
+ #endif
+ }
+A_STATIC inline AF1 CasCpuHWeightRcp(AF1 a){
+ #ifdef CAS_GO_SLOWER
+  return CasCpuHRnd(ARcpF1(a));
+ #else
+  // APrxMedRcpH1().
+  AF1 b=AF1_AH1_AU1((0x778du-CasCpuHBits(a))&0xffffu);
+  return CasCpuHMul(b,CasCpuHAdd(CasCpuHMul(-b,a),2.0f));
+ #endif
+ }
+//------------------------------------------------------------------------------------------------------------------------------
+// Clamp-to-edge texel converted to half.
+A_STATIC inline void CasCpuHTexel(AF1*A_RESTRICT v,const CasCpuImage&img,ASU1 x,ASU1 y){
+ x=x<0?0:(x>=ASU1(img.width)?ASU1(img.width)-1:x);
+ y=y<0?0:(y>=ASU1(img.height)?ASU1(img.height)-1:y);
+ AF1*pr[4];
+ CasCpuTexelLd(v,CasCpuRowAt(img,0,AU1(y),pr),img.format,AU1(x));
+ for(AU1 c=0;c<4;c++)v[c]=CasCpuHRnd(v[c]);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Amount of sharpening from the soft min and max.
+A_STATIC inline AF1 CasCpuHAmp(AF1 mn,AF1 mx,AF1 peak){
+ #ifdef CAS_BETTER_DIAGONALS
+  AF1 lim=2.0f;
+ #else
+  AF1 lim=1.0f;
+ #endif
+ AF1 amp=CasCpuHSat(CasCpuHMul(AMinF1(mn,CasCpuHSub(lim,mx)),CasCpuHAmpRcp(mx)));
+ return CasCpuHMul(CasCpuHAmpSqrt(amp),peak);}
+//==============================================================================================================================
+// One output pixel of CasFilterH(), 'pix' gets RGBA halves as floats.
+A_STATIC void CasCpuFilterHTexel(AF1*A_RESTRICT pix,AU1 ipX,AU1 ipY,inAU4 const0,inAU4 const1,AP1 noScaling,
+const CasCpuImage&src){
+ AU1 k;
+ #ifdef CAS_DEBUG_CHECKER
+  if((((ipX^ipY)>>8u)&1u)==0u){CasCpuHTexel(pix,src,ASU1(ipX),ASU1(ipY));return;}
+ #endif
+ AF1 peak=AF1_AH1_AU1(const1[1]&0xffffu);
+//------------------------------------------------------------------------------------------------------------------------------
+ if(noScaling){
+  ASU1 x=ASU1(ipX),y=ASU1(ipY);
+  //  a b c
+  //  d e f
+  //  g h i
+  AF1 a[4],b[4],c[4],d[4],e[4],f[4],g[4],h[4],i[4];
+  CasCpuHTexel(a,src,x-1,y-1);CasCpuHTexel(b,src,x,y-1);CasCpuHTexel(c,src,x+1,y-1);
+  CasCpuHTexel(d,src,x-1,y  );CasCpuHTexel(e,src,x,y  );CasCpuHTexel(f,src,x+1,y  );
+  CasCpuHTexel(g,src,x-1,y+1);CasCpuHTexel(h,src,x,y+1);CasCpuHTexel(i,src,x+1,y+1);
+  AF1 wt[3];
+  for(k=0;k<3;k++){
+   AF1 mn=AMinF1(AMinF1(f[k],h[k]),AMinF1(AMinF1(b[k],d[k]),e[k]));
+   AF1 mx=AMaxF1(AMaxF1(f[k],h[k]),AMaxF1(AMaxF1(b[k],d[k]),e[k]));
+   #ifdef CAS_BETTER_DIAGONALS
+    mn=CasCpuHAdd(mn,AMinF1(AMinF1(g[k],i[k]),AMinF1(AMinF1(a[k],c[k]),mn)));
+    mx=CasCpuHAdd(mx,AMaxF1(AMaxF1(g[k],i[k]),AMaxF1(AMaxF1(a[k],c[k]),mx)));
+   #endif
+   wt[k]=CasCpuHAmp(mn,mx,peak);}
+  for(k=0;k<3;k++){
+   #ifdef CAS_SLOW
+    AF1 w=wt[k];
+   #else
+    AF1 w=wt[1];
+   #endif
+   AF1 rcpWeight=CasCpuHWeightRcp(CasCpuHAdd(1.0f,CasCpuHMul(4.0f,w)));
+   AF1 o=CasCpuHAdd(CasCpuHMul(b[k],w),CasCpuHMul(d[k],w));
+   o=CasCpuHAdd(o,CasCpuHMul(f[k],w));
+   o=CasCpuHAdd(o,CasCpuHMul(h[k],w));
+   o=CasCpuHAdd(o,e[k]);
+   pix[k]=CasCpuHSat(CasCpuHMul(o,rcpWeight));}
+  pix[3]=e[3];
+  return;}
+//------------------------------------------------------------------------------------------------------------------------------
+ //  a b c d
+ //  e f g h
+ //  i j k l
+ //  m n o p
+ AU1 lane=(ipX>>3)&1u;
+ AF1 ppX=AF1(ipX-8u*lane)*AF1_AU1(const0[0])+AF1_AU1(const0[2]);
+ AF1 ppY=AF1(ipY)*AF1_AU1(const0[1])+AF1_AU1(const0[3]);
+ if(lane)ppX+=AF1_AU1(const1[2]);
+ AF1 fpX=AFloorF1(ppX),fpY=AFloorF1(ppY);
+ ppX=CasCpuHRnd(ppX-fpX);
+ ppY=CasCpuHRnd(ppY-fpY);
+ ASU1 x=ASU1(fpX),y=ASU1(fpY);
+ AF1 a[4],b[4],c[4],d[4],e[4],f[4],g[4],h[4],i[4],j[4],kk[4],l[4],m[4],n[4],o[4],p[4];
+ CasCpuHTexel(a,src,x-1,y-1);CasCpuHTexel(b,src,x,y-1);CasCpuHTexel(c ,src,x+1,y-1);CasCpuHTexel(d,src,x+2,y-1);
+ CasCpuHTexel(e,src,x-1,y  );CasCpuHTexel(f,src,x,y  );CasCpuHTexel(g ,src,x+1,y  );CasCpuHTexel(h,src,x+2,y  );
+ CasCpuHTexel(i,src,x-1,y+1);CasCpuHTexel(j,src,x,y+1);CasCpuHTexel(kk,src,x+1,y+1);CasCpuHTexel(l,src,x+2,y+1);
+ CasCpuHTexel(m,src,x-1,y+2);CasCpuHTexel(n,src,x,y+2);CasCpuHTexel(o ,src,x+1,y+2);CasCpuHTexel(p,src,x+2,y+2);
+ // Soft min and max for [F], [G], [J], [K], then filter shape weights.
+ AF1 mnf[3],mxf[3],mng[3],mxg[3],mnj[3],mxj[3],mnk[3],mxk[3];
+ AF1 wf[3],wg[3],wj[3],wk[3];
+ for(k=0;k<3;k++){
+  mnf[k]=CasCpuHMin3(CasCpuHMin3(b[k],e[k],f[k]),g[k],j[k]);
+  mxf[k]=CasCpuHMax3(CasCpuHMax3(b[k],e[k],f[k]),g[k],j[k]);
+  mng[k]=CasCpuHMin3(CasCpuHMin3(c[k],f[k],g[k]),h[k],kk[k]);
+  mxg[k]=CasCpuHMax3(CasCpuHMax3(c[k],f[k],g[k]),h[k],kk[k]);
+  mnj[k]=CasCpuHMin3(CasCpuHMin3(f[k],i[k],j[k]),kk[k],n[k]);
+  mxj[k]=CasCpuHMax3(CasCpuHMax3(f[k],i[k],j[k]),kk[k],n[k]);
+  mnk[k]=CasCpuHMin3(CasCpuHMin3(g[k],j[k],kk[k]),l[k],o[k]);
+  mxk[k]=CasCpuHMax3(CasCpuHMax3(g[k],j[k],kk[k]),l[k],o[k]);
+  #ifdef CAS_BETTER_DIAGONALS
+   mnf[k]=CasCpuHAdd(mnf[k],CasCpuHMin3(CasCpuHMin3(mnf[k],a[k],c[k]),i[k],kk[k]));
+   mxf[k]=CasCpuHAdd(mxf[k],CasCpuHMax3(CasCpuHMax3(mxf[k],a[k],c[k]),i[k],kk[k]));
+   mng[k]=CasCpuHAdd(mng[k],CasCpuHMin3(CasCpuHMin3(mng[k],b[k],d[k]),j[k],l[k]));
+   mxg[k]=CasCpuHAdd(mxg[k],CasCpuHMax3(CasCpuHMax3(mxg[k],b[k],d[k]),j[k],l[k]));
+   mnj[k]=CasCpuHAdd(mnj[k],CasCpuHMin3(CasCpuHMin3(mnj[k],e[k],g[k]),m[k],o[k]));
+   mxj[k]=CasCpuHAdd(mxj[k],CasCpuHMax3(CasCpuHMax3(mxj[k],e[k],g[k]),m[k],o[k]));
+   mnk[k]=CasCpuHAdd(mnk[k],CasCpuHMin3(CasCpuHMin3(mnk[k],f[k],h[k]),n[k],p[k]));
+   mxk[k]=CasCpuHAdd(mxk[k],CasCpuHMax3(CasCpuHMax3(mxk[k],f[k],h[k]),n[k],p[k]));
+  #endif
+  wf[k]=CasCpuHAmp(mnf[k],mxf[k],peak);
+  wg[k]=CasCpuHAmp(mng[k],mxg[k],peak);
+  wj[k]=CasCpuHAmp(mnj[k],mxj[k],peak);
+  wk[k]=CasCpuHAmp(mnk[k],mxk[k],peak);}
+ // Blend between 4 results, thinning edges.
+ //  s t
+ //  u v
+ AF1 ppXN=CasCpuHSub(1.0f,ppX),ppYN=CasCpuHSub(1.0f,ppY);
+ AF1 s=CasCpuHMul(ppXN,ppYN);
+ AF1 t=CasCpuHMul(ppX ,ppYN);
+ AF1 u=CasCpuHMul(ppXN,ppY );
+ AF1 v=CasCpuHMul(ppX ,ppY );
+ AF1 thinB=1.0f/32.0f;
+ s=CasCpuHMul(s,CasCpuHAmpRcp(CasCpuHAdd(thinB,CasCpuHSub(mxf[1],mnf[1]))));
+ t=CasCpuHMul(t,CasCpuHAmpRcp(CasCpuHAdd(thinB,CasCpuHSub(mxg[1],mng[1]))));
+ u=CasCpuHMul(u,CasCpuHAmpRcp(CasCpuHAdd(thinB,CasCpuHSub(mxj[1],mnj[1]))));
+ v=CasCpuHMul(v,CasCpuHAmpRcp(CasCpuHAdd(thinB,CasCpuHSub(mxk[1],mnk[1]))));
+ // Final weighting and filter.
+ for(k=0;k<3;k++){
+  #ifdef CAS_SLOW
+   AU1 q=k;
+  #else
+   AU1 q=1;
+  #endif
+  AF1 qbe=CasCpuHMul(wf[q],s);
+  AF1 qch=CasCpuHMul(wg[q],t);
+  AF1 qf=CasCpuHAdd(CasCpuHAdd(CasCpuHMul(wg[q],t),CasCpuHMul(wj[q],u)),s);
+  AF1 qg=CasCpuHAdd(CasCpuHAdd(CasCpuHMul(wf[q],s),CasCpuHMul(wk[q],v)),t);
+  AF1 qj=CasCpuHAdd(CasCpuHAdd(CasCpuHMul(wf[q],s),CasCpuHMul(wk[q],v)),u);
+  AF1 qk=CasCpuHAdd(CasCpuHAdd(CasCpuHMul(wg[q],t),CasCpuHMul(wj[q],u)),v);
+  AF1 qin=CasCpuHMul(wj[q],u);
+  AF1 qlo=CasCpuHMul(wk[q],v);
+  AF1 sw=CasCpuHAdd(CasCpuHMul(2.0f,qbe),CasCpuHMul(2.0f,qch));
+  sw=CasCpuHAdd(sw,CasCpuHMul(2.0f,qin));
+  sw=CasCpuHAdd(sw,CasCpuHMul(2.0f,qlo));
+  sw=CasCpuHAdd(CasCpuHAdd(CasCpuHAdd(CasCpuHAdd(sw,qf),qg),qj),qk);
+  AF1 rcpW=CasCpuHWeightRcp(sw);
+  const AF1*tap[12]={b,e,c,h,i,n,l,o,f,g,j,kk};
+  const AF1 wt[12]={qbe,qbe,qch,qch,qin,qin,qlo,qlo,qf,qg,qj,qk};
+  AF1 r=CasCpuHMul(tap[0][k],wt[0]);
+  for(AU1 z=1;z<12;z++)r=CasCpuHAdd(r,CasCpuHMul(tap[z][k],wt[z]));
+  pix[k]=CasCpuHSat(CasCpuHMul(r,rcpW));}
+ pix[3]=f[3];}
+//------------------------------------------------------------------------------------------------------------------------------
+// Emulate output pixels [x0,x1) by [y0,y1), the same signature as the kernel's CasFilterRect() so it can run on tiles.
+// Sources and destinations can be RGBA32F, RGBA16F, or PLANAR32F, half results store exactly in any of them.
+A_STATIC void CasCpuFilterHRect(const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling,
+AU1 x0,AU1 y0,AU1 x1,AU1 y1,CasCpuRows&rows,const CasCpuPhase*phase){
+ (void)rows;(void)phase;
+ for(AU1 y=y0;y<y1;y++)for(AU1 x=x0;x<x1;x++){
+  AF1 pix[4];CasCpuFilterHTexel(pix,x,y,const0,const1,noScaling,src);
+  AF1*pr[4];CasCpuTexelSt(CasCpuRowAt(dst,0,y,pr),dst.format,x,pix);}}
+//------------------------------------------------------------------------------------------------------------------------------
+// Emulate CasFilterH() on a whole image, use the same 'noScaling' and sizes as were used for CasSetup().
+A_STATIC void CasCpuFilterH(const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,AP1 noScaling){
+ CasCpuRows rows;
+ CasCpuFilterHRect(dst,src,const0,const1,noScaling,0,0,dst.width,dst.height,rows,nullptr);}
+//------------------------------------------------------------------------------------------------------------------------------
+// Same across 'pool' in 16x16 tiles, the emulation is slow so this is the one to use on large images.
+A_STATIC void CasCpuFilterHTiled(CasCpuPool&pool,const CasCpuImage&dst,const CasCpuImage&src,inAU4 const0,inAU4 const1,
+AP1 noScaling){
+ CasCpuTiles t;
+ AU1 n=CasCpuTilesInit(t,CasCpuFilterHRect,dst,src,const0,const1,noScaling,16,16,nullptr);
+ pool.Run(n,CasCpuTileTask,&t);}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                       YUV 4:2:0
+//------------------------------------------------------------------------------------------------------------------------------
+// Planar video frames, CAS runs on luma alone as a one channel image, chroma is copied or bilinear scaled.
+//  - Planes are R8, or R16 for deeper video with the samples MSB aligned, so the range is always 0 to 65535.
+//  - Chroma planes are (width+1)/2 by (height+1)/2.
+//  - Chroma siting {sitX,sitY} is the luma position of chroma sample 0, in luma texels from luma sample 0.
+//    That is {0.5,0.5} for centered (JPEG) siting, {0.0,0.5} for left (MPEG-2) siting.
+// Y4M streams (YUV4MPEG2) with the 4:2:0 colorspaces are read and written directly.
+//==============================================================================================================================
+#define CAS_CPU_Y4M_MAX_LINE 1024
+// Chroma rows per task.
+#define CAS_CPU_CHROMA_ROWS 16
+//------------------------------------------------------------------------------------------------------------------------------
+struct CasCpuYuv{
+ CasCpuImage y;
+ CasCpuImage u;
+ CasCpuImage v;
+ // Backing store from CasCpuYuvInit(), the views point into it so do not copy an initialized frame.
+ std::vector<AB1> mem;};
+//------------------------------------------------------------------------------------------------------------------------------
+// Allocate tightly packed planes for a 'width' by 'height' frame in one channel format 'fmt'.
+A_STATIC inline void CasCpuYuvInit(CasCpuYuv&f,AU1 width,AU1 height,AU1 fmt){
+ AU1 bpp=CasCpuFormatBytes(fmt),cw=(width+1)/2,ch=(height+1)/2;
+ size_t ys=size_t(width)*height*bpp,cs=size_t(cw)*ch*bpp;
+ f.mem.resize(ys+2*cs);
+ f.y={f.mem.data(),width,height,size_t(width)*bpp,fmt};
+ f.u={f.mem.data()+ys,cw,ch,size_t(cw)*bpp,fmt};
+ f.v={f.mem.data()+ys+cs,cw,ch,size_t(cw)*bpp,fmt};}
+//------------------------------------------------------------------------------------------------------------------------------
+// Code of texel 'x', and store of a code rounded to nearest.
+A_STATIC inline AF1 CasCpuMonoLd(const void*row,AU1 fmt,ASU1 x){
+ return fmt==CAS_CPU_FORMAT_R8?AF1(((const AB1*)row)[x]):AF1(((const AW1*)row)[x]);}
+A_STATIC inline void CasCpuMonoSt(void*row,AU1 fmt,AU1 x,AF1 v){
+ if(fmt==CAS_CPU_FORMAT_R8)((AB1*)row)[x]=AB1(v+0.5f);else((AW1*)row)[x]=AW1(v+0.5f);}
+//------------------------------------------------------------------------------------------------------------------------------
+// One job for a frame, luma tiles first, then bands of chroma rows of both planes.
+struct CasCpuYuvJob{
+ CasCpuTiles t;
+ const CasCpuYuv*dst;
+ const CasCpuYuv*src;
+ // Chroma phase tables, unused when chroma is copied.
+ std::vector<ASU1> ix;
+ std::vector<AF1> fx;
+ std::vector<ASU1> iy;
+ std::vector<AF1> fy;
+ AP1 copy;
+ AU1 tiles;
+ AU1 bands;};
+//------------------------------------------------------------------------------------------------------------------------------
+// Chroma rows [y0,y1) of 'dst' from 'src', clamp-to-edge bilinear through the job's tables.
+A_STATIC inline void CasCpuChromaRows(const CasCpuYuvJob&j,const CasCpuImage&dst,const CasCpuImage&src,AU1 y0,AU1 y1){
+ AU1 fmt=dst.format;
+ size_t bytes=size_t(dst.width)*CasCpuFormatBytes(fmt);
+ for(AU1 y=y0;y<y1;y++){
+  if(j.copy){memcpy(CasCpuRowW(dst,y),CasCpuRow(src,y),bytes);continue;}
+  ASU1 sy=j.iy[y];AF1 wy=j.fy[y];
+  const void*r0=CasCpuRow(src,AU1(AMaxSU1(0,AMinSU1(sy,ASU1(src.height)-1))));
+  const void*r1=CasCpuRow(src,AU1(AMaxSU1(0,AMinSU1(sy+1,ASU1(src.height)-1))));
+  void*o=CasCpuRowW(dst,y);
+  ASU1 last=ASU1(src.width)-1;
+  for(AU1 x=0;x<dst.width;x++){
+   ASU1 sx=j.ix[x];AF1 wx=j.fx[x];
+   ASU1 x0=AMaxSU1(0,AMinSU1(sx,last)),x1=AMaxSU1(0,AMinSU1(sx+1,last));
+   AF1 a=CasCpuMonoLd(r0,fmt,x0),b=CasCpuMonoLd(r0,fmt,x1),c=CasCpuMonoLd(r1,fmt,x0),d=CasCpuMonoLd(r1,fmt,x1);
+   a+=(b-a)*wx;c+=(d-c)*wx;
+   CasCpuMonoSt(o,fmt,x,a+(c-a)*wy);}}}
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC inline void CasCpuYuvTask(void*ctx,AU1 task,AU1 worker){
+ CasCpuYuvJob&j=*(CasCpuYuvJob*)ctx;
+ if(task<j.tiles){CasCpuTileTask(&j.t,task,worker);return;}
+ task-=j.tiles;
+ AP1 v=task>=j.bands;
+ AU1 y0=(v?task-j.bands:task)*CAS_CPU_CHROMA_ROWS;
+ const CasCpuImage&d=v?j.dst->v:j.dst->u;
+ CasCpuChromaRows(j,d,v?j.src->v:j.src->u,y0,AMinU1(y0+CAS_CPU_CHROMA_ROWS,d.height));}
+//------------------------------------------------------------------------------------------------------------------------------
+// Filter a frame across 'pool', luma with the bound kernel, chroma copied (sharpen-only) or bilinear scaled.
+// Use the same 'noScaling' and luma sizes as were used for CasSetup(), 'phase' is optional as for CasCpuFilterTiled().
+// Returns false without filtering if the frames are not 4:2:0 in one matching one channel format,
+// or if the scaling is beyond what CasSupportScaling() allows.
+A_STATIC inline AP1 CasCpuFilterYuv(CasCpuPool&pool,const CasCpuYuv&dst,const CasCpuYuv&src,inAU4 const0,inAU4 const1,
+AP1 noScaling,AF1 sitX=0.5f,AF1 sitY=0.5f,const CasCpuPhase*phase=nullptr){
+ AU1 fmt=src.y.format;
+ if(!CasCpuFormatMono(fmt))return false;
+ const CasCpuYuv*f[2]={&dst,&src};
+ for(AU1 i=0;i<2;i++){
+  const CasCpuYuv&q=*f[i];
+  if(q.y.format!=fmt||q.u.format!=fmt||q.v.format!=fmt||q.y.width==0||q.y.height==0)return false;
+  AU1 cw=(q.y.width+1)/2,ch=(q.y.height+1)/2;
+  if(q.u.width!=cw||q.u.height!=ch||q.v.width!=cw||q.v.height!=ch)return false;}
+ if(noScaling){if(dst.y.width!=src.y.width||dst.y.height!=src.y.height)return false;}
+ else if(!CasSupportScaling(AF1(dst.y.width),AF1(dst.y.height),AF1(src.y.width),AF1(src.y.height)))return false;
+ CasCpuYuvJob j;
+ j.bands=(dst.u.height+CAS_CPU_CHROMA_ROWS-1)/CAS_CPU_CHROMA_ROWS;
+ // One channel rows decode fast, wider tiles halve the overlap.
+ j.tiles=CasCpuTilesInit(j.t,CasCpuKernelRect(CasCpuKernel()),dst.y,src.y,const0,const1,noScaling,64,16,phase,
+  CAS_CPU_TASKS_MAX-2*j.bands);
+ j.dst=&dst;j.src=&src;
+ j.copy=noScaling;
+ if(!noScaling){
+  // Chroma 'j' sits at luma 2*j+sit, which maps through the luma scale and back to source chroma.
+  AF1 rx=AF1(src.y.width)/AF1(dst.y.width),ry=AF1(src.y.height)/AF1(dst.y.height);
+  CasCpuPhaseAxis(j.ix,j.fx,rx,((sitX+0.5f)*rx-0.5f-sitX)*0.5f,0,dst.u.width);
+  CasCpuPhaseAxis(j.iy,j.fy,ry,((sitY+0.5f)*ry-0.5f-sitY)*0.5f,0,dst.u.height);}
+ pool.Run(j.tiles+2*j.bands,CasCpuYuvTask,&j);
+ return true;}
+//==============================================================================================================================
+// Y4M stream header, 'format' and 'bits' are the in memory format and the bits per sample in the stream.
+struct CasCpuY4m{
+ AU1 width;
+ AU1 height;
+ AU1 format;
+ AU1 bits;
+ AF1 sitX;
+ AF1 sitY;
+ // The colorspace without the 'C', and the other parameters (each with its leading space), written back as is.
+ std::string colorspace;
+ std::string params;};
+//------------------------------------------------------------------------------------------------------------------------------
+// Read the header line, false on anything but a 4:2:0 YUV4MPEG2 stream.
+// Without a 'C' parameter the stream is C420jpeg, C420paldv chroma is treated as co-sited at the top left.
+A_STATIC inline AP1 CasCpuY4mReadHeader(FILE*f,CasCpuY4m&h){
+ char line[CAS_CPU_Y4M_MAX_LINE];
+ if(!fgets(line,sizeof(line),f)||strncmp(line,"YUV4MPEG2 ",10)!=0||!strchr(line,'\n'))return false;
+ h.width=h.height=0;
+ h.colorspace="420jpeg";
+ h.params.clear();
+ for(char*t=strtok(line+10," \n");t;t=strtok(nullptr," \n")){
+  if(t[0]=='W')h.width=AU1(strtoul(t+1,nullptr,10));
+  else if(t[0]=='H')h.height=AU1(strtoul(t+1,nullptr,10));
+  else if(t[0]=='C')h.colorspace=t+1;
+  else{h.params+=' ';h.params+=t;}}
+ const std::string&c=h.colorspace;
+ h.bits=8;h.sitX=0.5f;h.sitY=0.5f;
+ if(c=="420mpeg2")h.sitX=0.0f;
+ else if(c=="420paldv"){h.sitX=0.0f;h.sitY=0.0f;}
+ else if(c.size()==6&&c.compare(0,4,"420p")==0)h.bits=AU1(atoi(c.c_str()+4));
+ else if(c!="420jpeg"&&c!="420")return false;
+ if(h.bits<8||h.bits>16||h.width==0||h.height==0)return false;
+ h.format=h.bits>8?CAS_CPU_FORMAT_R16:CAS_CPU_FORMAT_R8;
+ return true;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Write the header, for scaling change 'width' and 'height' first.
+A_STATIC inline AP1 CasCpuY4mWriteHeader(FILE*f,const CasCpuY4m&h){
+ return fprintf(f,"YUV4MPEG2 W%u H%u%s C%s\n",h.width,h.height,h.params.c_str(),h.colorspace.c_str())>0;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Read the next frame into 'frame' from CasCpuYuvInit() with the stream's size and format, false at the end of the stream.
+// Deeper samples are little endian in the stream, they are scaled up to 16 bits by replicating the top bits.
+A_STATIC inline AP1 CasCpuY4mReadFrame(FILE*f,const CasCpuY4m&h,CasCpuYuv&frame){
+ char line[CAS_CPU_Y4M_MAX_LINE];
+ if(!fgets(line,sizeof(line),f)||strncmp(line,"FRAME",5)!=0||!strchr(line,'\n'))return false;
+ const CasCpuImage*pl[3]={&frame.y,&frame.u,&frame.v};
+ AU1 s=16-h.bits;
+ for(AU1 p=0;p<3;p++){
+  const CasCpuImage&img=*pl[p];
+  for(AU1 y=0;y<img.height;y++){
+   AB1*r=(AB1*)CasCpuRowW(img,y);
+   if(fread(r,CasCpuFormatBytes(img.format),img.width,f)!=img.width)return false;
+   if(img.format==CAS_CPU_FORMAT_R16)for(AU1 x=0;x<img.width;x++){
+    AU1 v=AU1(r[2*x])|(AU1(r[2*x+1])<<8);
+    ((AW1*)r)[x]=AW1(s?((v<<s)|(v>>(h.bits-s))):v);}}}
+ return true;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Write 'frame' with the stream's size and format, deeper samples are rounded back to 'bits'.
+A_STATIC inline AP1 CasCpuY4mWriteFrame(FILE*f,const CasCpuY4m&h,const CasCpuYuv&frame){
+ if(fputs("FRAME\n",f)<0)return false;
+ const CasCpuImage*pl[3]={&frame.y,&frame.u,&frame.v};
+ AU1 mx=(1u<<h.bits)-1u;
+ std::vector<AB1> tmp;
+ for(AU1 p=0;p<3;p++){
+  const CasCpuImage&img=*pl[p];
+  AU1 bpp=CasCpuFormatBytes(img.format);
+  tmp.resize(size_t(img.width)*bpp);
+  for(AU1 y=0;y<img.height;y++){
+   const AB1*r=(const AB1*)CasCpuRow(img,y);
+   if(img.format==CAS_CPU_FORMAT_R16){
+    for(AU1 x=0;x<img.width;x++){
+     AU1 v=(AU1(((const AW1*)r)[x])*mx+32767u)/65535u;
+     tmp[2*x]=AB1(v);tmp[2*x+1]=AB1(v>>8);}
+    r=tmp.data();}
+   if(fwrite(r,bpp,img.width,f)!=img.width)return false;}}
+ return true;}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                         PLANAR
+//------------------------------------------------------------------------------------------------------------------------------
+// PLANAR32F images hold one float plane per channel, the layout the kernels work in.
+//  - Source rows the kernel reads entirely inside the image are used in place, with no decode and no copy.
+//    With tiles that is every tile not touching the left or right edge, edge rows copy with clamp-to-edge padding.
+//  - Results store straight to the planes, without the interleave.
+//  - Without an alpha plane, alpha reads as 1 and is not written.
+//  - A tile row touches every plane, so give tiles the same bytes per row as RGBA32F, 4x the width in texels.
+//    At 1080p 64x16 tiles run about 2x slower than RGBA32F, 256x16 tiles match it.
+// CasCpuConvert() interleaves and deinterleaves, for callers holding RGBA buffers on one side.
+//==============================================================================================================================
+// Planar image view, 'a' can be null.
+A_STATIC inline CasCpuImage CasCpuImagePlanar(AF1*r,AF1*g,AF1*b,AF1*a,AU1 width,AU1 height,size_t pitch){
+ CasCpuImage i={nullptr,width,height,pitch,CAS_CPU_FORMAT_PLANAR32F};
+ i.planes[0]=r;i.planes[1]=g;i.planes[2]=b;i.planes[3]=a;
+ return i;}
+//------------------------------------------------------------------------------------------------------------------------------
+typedef void (*CasCpuConvertFn)(const CasCpuImage&dst,const CasCpuImage&src,AU1 y0,AU1 y1,CasCpuRows&rows);
+//------------------------------------------------------------------------------------------------------------------------------
+// Convert function of kernel 'k', the caller must check support.
+A_STATIC CasCpuConvertFn CasCpuKernelConvert(AU1 k){
+ #ifdef CAS_CPU_X86
+  static const CasCpuConvertFn fn[CAS_CPU_KERNEL_COUNT]={CasCpuScalar::CasConvertRows,
+   CasCpuSse41::CasConvertRows,CasCpuAvx2::CasConvertRows,CasCpuAvx512::CasConvertRows};
+  return fn[k<CAS_CPU_KERNEL_COUNT?k:0];
+ #else
+  (void)k;return CasCpuScalar::CasConvertRows;
+ #endif
+ }
+//------------------------------------------------------------------------------------------------------------------------------
+// Convert 'src' into the format of 'dst' with the bound kernel, for example RGBA32F to PLANAR32F and back.
+// Both must be the same size, and neither one of the one channel formats.
+A_STATIC void CasCpuConvert(const CasCpuImage&dst,const CasCpuImage&src){
+ CasCpuRows rows;
+ CasCpuKernelConvert(CasCpuKernel())(dst,src,0,src.height,rows);}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//                                                          FILES
+//------------------------------------------------------------------------------------------------------------------------------
+// Memory mapped PFM, PGM, PPM, and headerless raw images, 'img' views the pixels in the mapping and the kernels work on that.
+//  - PFM maps to RGB32F or R32F, PGM and PPM to R8 and RGB8 (or R16 and RGB16), raw files to the format given.
+//  - Sources are mapped copy-on-write, fixing samples up in place never touches the file (and only copies those pages).
+//     - 16-bit PGM and PPM (and PFM with a positive scale) are big endian, those samples get swapped.
+//     - A 'maxval' other than 255 or 65535 gets rescaled to it.
+//     - Sample data at an offset not aligned to its size is moved down.
+//  - Destinations are sized and mapped up front with the header in place, 16-bit samples are swapped at CasCpuFileClose().
+//  - PFM rows run bottom to top, filtering in file order gives the same image (CAS is symmetric up to rounding).
+//    Pairing a PFM with another type flips the image vertically, CasCpuFileFlip() swaps the rows back.
+//  - Mappings are advised MADV_SEQUENTIAL, the kernels walk the rows in order.
+// Without mmap (CAS_CPU_MMAP 0) the same calls read the whole file into memory, and write it out at CasCpuFileClose().
+//==============================================================================================================================
+#define CAS_CPU_FILE_RAW 0
+#define CAS_CPU_FILE_PFM 1
+#define CAS_CPU_FILE_PNM 2
+//------------------------------------------------------------------------------------------------------------------------------
+// Mapped image file, from CasCpuFileOpen() or CasCpuFileCreate(), always finish with CasCpuFileClose().
+struct CasCpuFile{
+ CasCpuImage img={};
+ AU1 type=CAS_CPU_FILE_RAW;
+ // Rows are stored bottom to top (PFM).
+ AP1 bottomUp=false;
+ // Samples are big endian in the file.
+ AP1 swap=false;
+ AP1 write=false;
+ AB1*base=nullptr;
+ size_t size=0;
+ int fd=-1;
+ // Only used without mmap, to write the file at the close.
+ std::string path;};
+//------------------------------------------------------------------------------------------------------------------------------
+// Map 'path', for writing it gets created with 'size' bytes, for reading 'size' is the size of the file.
+A_STATIC inline AP1 CasCpuFileMap(CasCpuFile&f,const char*path,AP1 write,size_t size){
+ f.write=write;
+ #if CAS_CPU_MMAP
+  f.fd=open(path,write?O_RDWR|O_CREAT|O_TRUNC:O_RDONLY,0644);
+  if(f.fd<0)return false;
+  if(write){if(ftruncate(f.fd,off_t(size))!=0)return false;}
+  else{struct stat st;if(fstat(f.fd,&st)!=0)return false;size=size_t(st.st_size);}
+  if(size==0)return false;
+  // Sources are private and writable, for the in place fix ups.
+  void*m=mmap(nullptr,size,PROT_READ|PROT_WRITE,write?MAP_SHARED:MAP_PRIVATE,f.fd,0);
+  if(m==MAP_FAILED)return false;
+  madvise(m,size,MADV_SEQUENTIAL);
+  f.base=(AB1*)m;f.size=size;
+ #else
+  f.path=path;
+  if(!write){
+   FILE*fp=fopen(path,"rb");
+   if(!fp)return false;
+   long n=fseek(fp,0,SEEK_END)==0?ftell(fp):-1;
+   size=n>0?size_t(n):0;
+   f.base=size&&fseek(fp,0,SEEK_SET)==0?(AB1*)malloc(size):nullptr;
+   AP1 ok=f.base&&fread(f.base,1,size,fp)==size;
+   fclose(fp);
+   if(!ok)return false;}
+  else if(size==0||!(f.base=(AB1*)calloc(size,1)))return false;
+  f.size=size;
+ #endif
+ return true;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Swap the byte order of the samples of 'img', and for sources rescale a 'maxval' other than the full range.
+A_STATIC inline void CasCpuFileFix(const CasCpuFile&f,AU1 maxval){
+ const CasCpuImage&i=f.img;
+ size_t n=size_t(i.width)*i.height*CasCpuFormatBytes(i.format);
+ AU1 full=(i.format==CAS_CPU_FORMAT_R8||i.format==CAS_CPU_FORMAT_RGB8)?255u:65535u;
+ if(maxval==0)maxval=full;
+ if(i.format==CAS_CPU_FORMAT_R32F||i.format==CAS_CPU_FORMAT_RGB32F){
+  AU1*p=(AU1*)i.data;
+  if(f.swap)for(size_t j=0;j<n/4;j++)p[j]=(p[j]>>24)|((p[j]>>8)&0xff00u)|((p[j]<<8)&0xff0000u)|(p[j]<<24);}
+ else if(full==65535u){
+  AW1*p=(AW1*)i.data;
+  if(f.swap)for(size_t j=0;j<n/2;j++)p[j]=AW1((p[j]>>8)|(p[j]<<8));
+  if(maxval!=full)for(size_t j=0;j<n/2;j++)p[j]=AW1((AU1(AMinU1(p[j],maxval))*full+maxval/2)/maxval);}
+ else if(maxval!=full){
+  AB1*p=(AB1*)i.data;
+  for(size_t j=0;j<n;j++)p[j]=AB1((AU1(AMinU1(p[j],maxval))*full+maxval/2)/maxval);}}
+//------------------------------------------------------------------------------------------------------------------------------
+// Unmap (writing destinations back), false if anything failed.
+A_STATIC inline AP1 CasCpuFileClose(CasCpuFile&f){
+ AP1 ok=true;
+ if(f.base&&f.write&&f.swap)CasCpuFileFix(f,0);
+ #if CAS_CPU_MMAP
+  if(f.base)ok=munmap(f.base,f.size)==0;
+  if(f.fd>=0)ok=close(f.fd)==0&&ok;
+ #else
+  if(f.base&&f.write){
+   FILE*fp=fopen(f.path.c_str(),"wb");
+   ok=fp&&fwrite(f.base,1,f.size,fp)==f.size;
+   if(fp)ok=fclose(fp)==0&&ok;}
+  free(f.base);
+ #endif
+ f.base=nullptr;f.size=0;f.fd=-1;f.img.data=nullptr;
+ return ok;}
+//------------------------------------------------------------------------------------------------------------------------------
+A_STATIC inline AP1 CasCpuFileSpace(AB1 c){return c==' '||c=='\t'||c=='\n'||c=='\r'||c=='\v'||c=='\f';}
+// Next header token from offset 'o', skipping whitespace and '#' comments, false if missing or too long.
+A_STATIC inline AP1 CasCpuFileToken(const CasCpuFile&f,size_t&o,char(&t)[32]){
+ for(;;){
+  while(o<f.size&&CasCpuFileSpace(f.base[o]))o++;
+  if(o>=f.size||f.base[o]!='#')break;
+  while(o<f.size&&f.base[o]!='\n')o++;}
+ AU1 n=0;
+ while(o<f.size&&!CasCpuFileSpace(f.base[o])&&n<31)t[n++]=char(f.base[o++]);
+ t[n]=0;
+ return n>0&&n<31;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Header dimension token as a number, 0 if it is not all digits or does not fit 32 bits.
+A_STATIC inline AU1 CasCpuFileDim(const char*t){
+ char*e;
+ unsigned long long v=strtoull(t,&e,10);
+ return t[0]>='0'&&t[0]<='9'&&*e==0&&v<=0xffffffffull?AU1(v):0u;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Bytes of a 'w' x 'h' image of 'bpp' byte pixels, false if either is 0 or the size does not fit a size_t.
+A_STATIC inline AP1 CasCpuFileBytes(size_t&bytes,AU1 w,AU1 h,AU1 bpp){
+ if(w==0||h==0||bpp==0||w>SIZE_MAX/bpp/h)return false;
+ bytes=size_t(w)*h*bpp;
+ return true;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Map a PFM ('PF' or 'Pf'), PGM ('P5'), or PPM ('P6') image for reading, the type comes from the header.
+A_STATIC inline AP1 CasCpuFileOpen(CasCpuFile&f,const char*path){
+ char t[32],tw[32],th[32],tm[32];
+ size_t o=0;
+ if(!CasCpuFileMap(f,path,false,0)||!CasCpuFileToken(f,o,t)||t[0]!='P'||t[1]==0||t[2]!=0||
+  !CasCpuFileToken(f,o,tw)||!CasCpuFileToken(f,o,th)||!CasCpuFileToken(f,o,tm)||
+  o>=f.size||!CasCpuFileSpace(f.base[o++])){CasCpuFileClose(f);return false;}
+ AU1 w=CasCpuFileDim(tw),h=CasCpuFileDim(th),fmt,maxval=0;
+ AP1 rgb=t[1]=='F'||t[1]=='6';
+ if(t[1]=='F'||t[1]=='f'){
+  AF1 sc=AF1(strtod(tm,nullptr));
+  fmt=rgb?CAS_CPU_FORMAT_RGB32F:CAS_CPU_FORMAT_R32F;
+  f.type=CAS_CPU_FILE_PFM;f.bottomUp=true;f.swap=sc>0.0f;
+  if(sc==0.0f)w=0;}
+ else{
+  maxval=AU1(strtoul(tm,nullptr,10));
+  AP1 deep=maxval>255u;
+  fmt=rgb?(deep?CAS_CPU_FORMAT_RGB16:CAS_CPU_FORMAT_RGB8):(deep?CAS_CPU_FORMAT_R16:CAS_CPU_FORMAT_R8);
+  f.type=CAS_CPU_FILE_PNM;f.swap=deep;
+  if((t[1]!='5'&&t[1]!='6')||maxval==0||maxval>65535u)w=0;}
+ AU1 bpp=CasCpuFormatBytes(fmt),sample=rgb?bpp/3u:bpp;
+ size_t bytes=0;
+ if(!CasCpuFileBytes(bytes,w,h,bpp)||bytes>f.size-o){CasCpuFileClose(f);return false;}
+ // The mapping is private, so moving misaligned samples down leaves the file as is.
+ size_t a=o-o%sample;
+ if(a!=o)memmove(f.base+a,f.base+o,bytes);
+ f.img={f.base+a,w,h,size_t(w)*bpp,fmt};
+ CasCpuFileFix(f,maxval);
+ return true;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Map a headerless 'width' x 'height' image in 'format' (not PLANAR32F) with tightly packed rows for reading.
+A_STATIC inline AP1 CasCpuFileOpenRaw(CasCpuFile&f,const char*path,AU1 width,AU1 height,AU1 format){
+ size_t bytes=0;
+ if(format==CAS_CPU_FORMAT_PLANAR32F||format>CAS_CPU_FORMAT_RGB16||
+  !CasCpuFileBytes(bytes,width,height,CasCpuFormatBytes(format))||
+  !CasCpuFileMap(f,path,false,0)||bytes>f.size){CasCpuFileClose(f);return false;}
+ f.img={f.base,width,height,size_t(width)*CasCpuFormatBytes(format),format};
+ return true;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Create 'path' as a 'type' file of a 'width' x 'height' image in 'format', mapped for the filter to write 'img'.
+//  - CAS_CPU_FILE_PFM takes RGB32F or R32F, written little endian.
+//  - CAS_CPU_FILE_PNM takes R8 or R16 for PGM, RGB8 or RGB16 for PPM, written with a 'maxval' of 255 or 65535.
+//  - CAS_CPU_FILE_RAW takes any format but PLANAR32F.
+A_STATIC inline AP1 CasCpuFileCreate(CasCpuFile&f,const char*path,AU1 type,AU1 width,AU1 height,AU1 format){
+ AP1 mono=CasCpuFormatMono(format);
+ AP1 deep=format==CAS_CPU_FORMAT_R16||format==CAS_CPU_FORMAT_RGB16;
+ char head[96];
+ int n=0;
+ if(type==CAS_CPU_FILE_PFM){
+  if(format!=CAS_CPU_FORMAT_RGB32F&&format!=CAS_CPU_FORMAT_R32F)return false;
+  // Pad the scale with zeros to start the samples 4 byte aligned.
+  n=snprintf(head,sizeof(head),"P%c\n%u %u\n-1.0",mono?'f':'F',width,height);
+  while((n+1)%4)head[n++]='0';
+  head[n++]='\n';}
+ else if(type==CAS_CPU_FILE_PNM){
+  if(!deep&&format!=CAS_CPU_FORMAT_R8&&format!=CAS_CPU_FORMAT_RGB8)return false;
+  // A second space between the width and height starts 16-bit samples 2 byte aligned.
+  n=snprintf(head,sizeof(head),"P%c\n%u %u\n%u\n",mono?'5':'6',width,height,deep?65535u:255u);
+  if(deep&&(n%2))n=snprintf(head,sizeof(head),"P%c\n%u  %u\n%u\n",mono?'5':'6',width,height,65535u);}
+ else if(type!=CAS_CPU_FILE_RAW||format==CAS_CPU_FORMAT_PLANAR32F||format>CAS_CPU_FORMAT_RGB16)return false;
+ size_t bytes=0;
+ if(!CasCpuFileBytes(bytes,width,height,CasCpuFormatBytes(format))||bytes>SIZE_MAX-size_t(n))return false;
+ size_t pitch=size_t(width)*CasCpuFormatBytes(format);
+ if(!CasCpuFileMap(f,path,true,size_t(n)+bytes)){CasCpuFileClose(f);return false;}
+ memcpy(f.base,head,size_t(n));
+ f.type=type;f.bottomUp=type==CAS_CPU_FILE_PFM;f.swap=type==CAS_CPU_FILE_PNM&&deep;
+ f.img={f.base+n,width,height,pitch,format};
+ return true;}
+//------------------------------------------------------------------------------------------------------------------------------
+// Reverse the row order of 'img' in place, for pairing a bottom up PFM with a top down type.
+A_STATIC inline void CasCpuFileFlip(const CasCpuFile&f){
+ size_t n=size_t(f.img.width)*CasCpuFormatBytes(f.img.format);
+ for(AU1 y=0;y<f.img.height/2;y++){
+  AB1*a=(AB1*)CasCpuRowW(f.img,y);
+  std::swap_ranges(a,a+n,(AB1*)CasCpuRowW(f.img,f.img.height-1-y));}}
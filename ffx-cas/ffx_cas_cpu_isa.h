@@ -0,0 +1,55 @@
+//_____________________________________________________________/\_______________________________________________________________
+//==============================================================================================================================
+//
+//                                 [CAS] FIDELITY FX - CONSTRAST ADAPTIVE SHARPENING CPU INSTRUCTION SETS
+//
+//==============================================================================================================================
+// Included by 'ffx_cas_cpu.h', do not include this directly.
+// Builds 'ffx_cas_cpu_kernel.h' once per instruction set, each in its own namespace inside the current one.
+// Gets included once at global scope, and once per variant with CAS_CPU_VARIANTS (see "VARIANTS" in 'ffx_cas_cpu.h').
+//==============================================================================================================================
+#define CAS_CPU_FN A_STATIC inline
+#define CAS_CPU_ISA CAS_CPU_ISA_SCALAR
+namespace CasCpuScalar{
+ #include "ffx_cas_cpu_kernel.h"
+}
+#undef CAS_CPU_ISA
+#undef CAS_CPU_FN
+//------------------------------------------------------------------------------------------------------------------------------
+#ifdef CAS_CPU_X86
+ #ifdef A_GCC
+  #define CAS_CPU_FN __attribute__((target("sse4.1"))) A_STATIC inline
+ #else
+  #define CAS_CPU_FN A_STATIC inline
+ #endif
+ #define CAS_CPU_ISA CAS_CPU_ISA_SSE41
+ namespace CasCpuSse41{
+  #include "ffx_cas_cpu_kernel.h"
+ }
+ #undef CAS_CPU_ISA
+ #undef CAS_CPU_FN
+//------------------------------------------------------------------------------------------------------------------------------
+ #ifdef A_GCC
+  #define CAS_CPU_FN __attribute__((target("avx2,fma,f16c"))) A_STATIC inline
+ #else
+  #define CAS_CPU_FN A_STATIC inline
+ #endif
+ #define CAS_CPU_ISA CAS_CPU_ISA_AVX2
+ namespace CasCpuAvx2{
+  #include "ffx_cas_cpu_kernel.h"
+ }
+ #undef CAS_CPU_ISA
+ #undef CAS_CPU_FN
+//------------------------------------------------------------------------------------------------------------------------------
+ #ifdef A_GCC
+  #define CAS_CPU_FN __attribute__((target("avx512f,avx2,fma,f16c"))) A_STATIC inline
+ #else
+  #define CAS_CPU_FN A_STATIC inline
+ #endif
+ #define CAS_CPU_ISA CAS_CPU_ISA_AVX512
+ namespace CasCpuAvx512{
+  #include "ffx_cas_cpu_kernel.h"
+ }
+ #undef CAS_CPU_ISA
+ #undef CAS_CPU_FN
+#endif
@@ -0,0 +1,415 @@
+//CAS Bench
+//
+// Copyright(c) 2020 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Benchmark of the CPU CAS runtime in 'ffx_cas_cpu.h', writing the results as JSON.
+// Sweeps kernels, compile variants, sharpen-only and upscaling at the CAS_AREA_LIMIT example resolutions, thread counts,
+// and sharpness, on synthetic images from a deterministic generator.
+
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define A_CPU 1
+#if defined(__GNUC__)
+#define A_GCC 1
+#endif
+#include "ffx_a.h"
+#include "ffx_cas.h"
+#include "ffx_cas_cpu.h"
+
+#include "CAS_Bench.h"
+
+BenchTiming BenchRun0(const BenchCase& c);
+BenchTiming BenchRun1(const BenchCase& c);
+BenchTiming BenchRun2(const BenchCase& c);
+BenchTiming BenchRun3(const BenchCase& c);
+BenchTiming BenchRun4(const BenchCase& c);
+BenchTiming BenchRun5(const BenchCase& c);
+BenchTiming BenchRun6(const BenchCase& c);
+BenchTiming BenchRun7(const BenchCase& c);
+
+const BenchVariant g_benchVariants[BENCH_VARIANT_COUNT] =
+{
+    { "default", false, false, false, BenchRun0 },
+    { "better_diagonals", true, false, false, BenchRun1 },
+    { "slow", false, true, false, BenchRun2 },
+    { "better_diagonals+slow", true, true, false, BenchRun3 },
+    { "go_slower", false, false, true, BenchRun4 },
+    { "better_diagonals+go_slower", true, false, true, BenchRun5 },
+    { "slow+go_slower", false, true, true, BenchRun6 },
+    { "better_diagonals+slow+go_slower", true, true, true, BenchRun7 },
+};
+
+// The example resolutions of the CAS_AREA_LIMIT comment in 'ffx_cas.h'.
+struct Resolution
+{
+    uint32_t inW, inH, outW, outH;
+};
+
+static const Resolution s_resolutions[] =
+{
+    { 1280, 720, 1920, 1080 },
+    { 1536, 864, 1920, 1080 },
+    { 1792, 1008, 2560, 1440 },
+    { 1920, 1080, 2560, 1440 },
+    { 1920, 1080, 3840, 2160 },
+    { 2048, 1152, 2560, 1440 },
+    { 2560, 1440, 3840, 2160 },
+    { 3072, 1728, 3840, 2160 },
+};
+
+struct Options
+{
+    std::vector<uint32_t> kernels;
+    std::vector<uint32_t> variants;
+    std::vector<Resolution> resolutions;
+    bool sharpen = true;
+    bool upscale = true;
+    std::vector<uint32_t> threads;
+    std::vector<float> sharpness;
+    uint32_t tileW = 16;
+    uint32_t tileH = 16;
+    uint32_t minIterations = 3;
+    double minSeconds = 0.25;
+    const char* output = nullptr;
+};
+
+//--------------------------------------------------------------------------------------
+//
+// Command line
+//
+//--------------------------------------------------------------------------------------
+static void PrintUsage()
+{
+    printf(
+        "Usage: CAS_Bench [options]\n"
+        "Lists are comma separated, each defaults to all of its values.\n"
+        "  --kernels <list>        scalar, sse4.1, avx2, avx512 (default: all the CPU supports)\n"
+        "  --variants <list>       default, better_diagonals, slow, go_slower, or '+' joined combinations\n"
+        "  --modes <list>          sharpen, upscale\n"
+        "  --resolutions <list>    <w>x<h>:<w>x<h> input to output pairs (default: the CAS_AREA_LIMIT examples)\n"
+        "                          sharpen-only runs at each distinct output size\n"
+        "  --threads <list>        Worker counts (default: 1 and one per hardware thread)\n"
+        "  --sharpness <list>      Values 0 to 1 (default: 0,0.5,1)\n"
+        "  --tile <w>x<h>          Tile size (default 16x16)\n"
+        "  --min-time <s>          Minimum timed seconds per case (default 0.25)\n"
+        "  --min-iterations <n>    Minimum timed runs per case (default 3)\n"
+        "  --out <file>            Write the JSON there instead of stdout\n");
+}
+
+static std::vector<std::string> Split(const char* s)
+{
+    std::vector<std::string> r;
+    std::string cur;
+    for (; ; s++)
+    {
+        if (*s == ',' || *s == 0)
+        {
+            if (!cur.empty())
+                r.push_back(cur);
+            cur.clear();
+            if (*s == 0)
+                break;
+        }
+        else
+            cur += *s;
+    }
+    return r;
+}
+
+static bool ParseSize(const char* s, uint32_t* pW, uint32_t* pH, const char** pEnd)
+{
+    char* end;
+    unsigned long w = strtoul(s, &end, 10);
+    if (*end != 'x' && *end != 'X')
+        return false;
+    unsigned long h = strtoul(end + 1, &end, 10);
+    if (w == 0 || h == 0 || w > 65536 || h > 65536)
+        return false;
+    *pW = uint32_t(w);
+    *pH = uint32_t(h);
+    *pEnd = end;
+    return true;
+}
+
+static int ParseOptions(int argc, char** argv, Options& o)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* a = argv[i];
+        if (strcmp(a, "--help") == 0 || strcmp(a, "-h") == 0)
+        {
+            PrintUsage();
+            return 2;
+        }
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!v)
+        {
+            fprintf(stderr, "Missing the value of '%s'\n", a);
+            return 1;
+        }
+        i++;
+        bool ok = true;
+        std::vector<std::string> list = Split(v);
+        if (strcmp(a, "--kernels") == 0)
+        {
+            for (const std::string& s : list)
+            {
+                uint32_t k = CasCpuKernelFromName(s.c_str());
+                ok = ok && k < CAS_CPU_KERNEL_COUNT;
+                o.kernels.push_back(k);
+            }
+        }
+        else if (strcmp(a, "--variants") == 0)
+        {
+            for (const std::string& s : list)
+            {
+                uint32_t n = 0;
+                while (n < BENCH_VARIANT_COUNT && s != g_benchVariants[n].name)
+                    n++;
+                ok = ok && n < BENCH_VARIANT_COUNT;
+                o.variants.push_back(n);
+            }
+        }
+        else if (strcmp(a, "--modes") == 0)
+        {
+            o.sharpen = o.upscale = false;
+            for (const std::string& s : list)
+            {
+                o.sharpen = o.sharpen || s == "sharpen";
+                o.upscale = o.upscale || s == "upscale";
+                ok = ok && (s == "sharpen" || s == "upscale");
+            }
+        }
+        else if (strcmp(a, "--resolutions") == 0)
+        {
+            for (const std::string& s : list)
+            {
+                Resolution r;
+                const char* end;
+                ok = ok && ParseSize(s.c_str(), &r.inW, &r.inH, &end) && *end == ':' &&
+                    ParseSize(end + 1, &r.outW, &r.outH, &end) && *end == 0 &&
+                    CasSupportScaling(AF1(r.outW), AF1(r.outH), AF1(r.inW), AF1(r.inH));
+                o.resolutions.push_back(r);
+            }
+        }
+        else if (strcmp(a, "--threads") == 0)
+        {
+            for (const std::string& s : list)
+            {
+                uint32_t t = uint32_t(atoi(s.c_str()));
+                ok = ok && t >= 1 && t <= 1024;
+                o.threads.push_back(t);
+            }
+        }
+        else if (strcmp(a, "--sharpness") == 0)
+        {
+            for (const std::string& s : list)
+            {
+                float f = float(atof(s.c_str()));
+                ok = ok && f >= 0.0f && f <= 1.0f;
+                o.sharpness.push_back(f);
+            }
+        }
+        else if (strcmp(a, "--tile") == 0)
+        {
+            const char* end;
+            ok = ParseSize(v, &o.tileW, &o.tileH, &end) && *end == 0;
+        }
+        else if (strcmp(a, "--min-time") == 0)
+        {
+            o.minSeconds = atof(v);
+            ok = o.minSeconds >= 0.0;
+        }
+        else if (strcmp(a, "--min-iterations") == 0)
+        {
+            o.minIterations = uint32_t(atoi(v));
+            ok = o.minIterations >= 1;
+        }
+        else if (strcmp(a, "--out") == 0)
+            o.output = v;
+        else
+        {
+            fprintf(stderr, "Unknown option '%s'\n", a);
+            return 1;
+        }
+        if (!ok || list.empty())
+        {
+            fprintf(stderr, "Bad value '%s' for '%s'\n", v, a);
+            return 1;
+        }
+    }
+    if (o.kernels.empty())
+        for (uint32_t k = 0; k <= CasCpuKernelSupported(); k++)
+            o.kernels.push_back(k);
+    if (o.variants.empty())
+        for (uint32_t n = 0; n < BENCH_VARIANT_COUNT; n++)
+            o.variants.push_back(n);
+    if (o.resolutions.empty())
+        o.resolutions.assign(s_resolutions, s_resolutions + sizeof(s_resolutions) / sizeof(s_resolutions[0]));
+    if (o.threads.empty())
+    {
+        uint32_t hw = std::thread::hardware_concurrency();
+        o.threads.push_back(1);
+        if (hw > 1)
+            o.threads.push_back(hw);
+    }
+    if (o.sharpness.empty())
+        o.sharpness = { 0.0f, 0.5f, 1.0f };
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// Synthetic images
+//
+//--------------------------------------------------------------------------------------
+static uint32_t Hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Gradients, hard edges, and noise (the mix CAS sees in rendered frames), the same on every run and platform.
+static void Generate(float* p, uint32_t w, uint32_t h)
+{
+    for (uint32_t y = 0; y < h; y++)
+        for (uint32_t x = 0; x < w; x++)
+        {
+            float* t = p + (size_t(y) * w + x) * 4;
+            float edge = ((x / 37 + y / 23) & 1) ? 0.3f : 0.0f;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                float ramp = float(c == 0 ? x : (c == 1 ? y : x + y)) / float(w + h);
+                float noise = float(Hash((y * w + x) * 3 + c) >> 8) * (1.0f / 16777216.0f);
+                t[c] = 0.4f * ramp + edge + 0.3f * noise;
+            }
+            t[3] = 1.0f;
+        }
+}
+
+//--------------------------------------------------------------------------------------
+//
+// main
+//
+//--------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    Options o;
+    int parsed = ParseOptions(argc, argv, o);
+    if (parsed)
+        return parsed == 2 ? 0 : 1;
+
+    // Sharpen-only at each distinct output size, then each upscale.
+    std::vector<Resolution> cases;
+    if (o.sharpen)
+        for (const Resolution& r : o.resolutions)
+        {
+            Resolution s = { r.outW, r.outH, r.outW, r.outH };
+            bool seen = false;
+            for (const Resolution& c : cases)
+                seen = seen || (c.inW == s.inW && c.inH == s.inH);
+            if (!seen)
+                cases.push_back(s);
+        }
+    if (o.upscale)
+        for (const Resolution& r : o.resolutions)
+            cases.push_back(r);
+
+    // Sources per input size, one destination big enough for all.
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<float>> sources;
+    size_t dstTexels = 0;
+    for (const Resolution& r : cases)
+    {
+        std::vector<float>& s = sources[std::make_pair(r.inW, r.inH)];
+        if (s.empty())
+        {
+            s.resize(size_t(r.inW) * r.inH * 4);
+            Generate(s.data(), r.inW, r.inH);
+        }
+        dstTexels = std::max(dstTexels, size_t(r.outW) * r.outH);
+    }
+    std::vector<float> dst(dstTexels * 4);
+
+    FILE* f = o.output ? fopen(o.output, "w") : stdout;
+    if (!f)
+    {
+        fprintf(stderr, "Can't write '%s'\n", o.output);
+        return 1;
+    }
+    fprintf(f, "{\n  \"cpu\": {\"bestKernel\": \"%s\", \"hardwareThreads\": %u},\n",
+        CasCpuKernelName(CasCpuKernelSupported()), std::thread::hardware_concurrency());
+#if defined(__VERSION__)
+    fprintf(f, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    fprintf(f, "  \"format\": \"rgba32f\",\n  \"tile\": [%u, %u],\n  \"results\": [", o.tileW, o.tileH);
+
+    bool first = true;
+    for (uint32_t k : o.kernels)
+    {
+        if (k > CasCpuKernelSupported())
+        {
+            fprintf(stderr, "Skipping kernel %s, the CPU lacks it\n", CasCpuKernelName(k));
+            continue;
+        }
+        for (uint32_t v : o.variants)
+            for (const Resolution& r : cases)
+                for (uint32_t t : o.threads)
+                    for (float s : o.sharpness)
+                    {
+                        const BenchVariant& bv = g_benchVariants[v];
+                        BenchCase c = { sources[std::make_pair(r.inW, r.inH)].data(), dst.data(), r.inW, r.inH, r.outW,
+                            r.outH, s, k, t, o.tileW, o.tileH, o.minIterations, o.minSeconds };
+                        BenchTiming bt = bv.fn(c);
+
+                        double outPixels = double(r.outW) * r.outH;
+                        double bytes = (double(r.inW) * r.inH + outPixels) * 16.0;
+                        bool sharpen = r.inW == r.outW && r.inH == r.outH;
+                        fprintf(f, "%s\n    {\"kernel\": \"%s\", \"variant\": \"%s\", \"betterDiagonals\": %s, "
+                            "\"slow\": %s, \"goSlower\": %s, \"mode\": \"%s\", \"input\": [%u, %u], \"output\": [%u, %u], "
+                            "\"threads\": %u, \"sharpness\": %g, \"iterations\": %u, \"bestMs\": %.4f, \"medianMs\": %.4f, "
+                            "\"mpixPerSec\": %.2f, \"nsPerPixel\": %.4f, \"gbPerSec\": %.3f}",
+                            first ? "" : ",", CasCpuKernelName(bt.kernel), bv.name, bv.betterDiagonals ? "true" : "false",
+                            bv.slow ? "true" : "false", bv.goSlower ? "true" : "false", sharpen ? "sharpen" : "upscale",
+                            r.inW, r.inH, r.outW, r.outH, t, s, bt.iterations, bt.best * 1e3, bt.median * 1e3,
+                            outPixels / bt.median * 1e-6, bt.median * 1e9 / outPixels, bytes / bt.median * 1e-9);
+                        fflush(f);
+                        first = false;
+                        fprintf(stderr, "%-7s %-32s %-7s %4ux%-4u -> %4ux%-4u %3u threads sharpness %.2f: %8.2f Mpix/s\n",
+                            CasCpuKernelName(bt.kernel), bv.name, sharpen ? "sharpen" : "upscale", r.inW, r.inH, r.outW,
+                            r.outH, t, s, outPixels / bt.median * 1e-6);
+                    }
+    }
+    fprintf(f, "\n  ]\n}\n");
+    if (f != stdout)
+        fclose(f);
+    return 0;
+}
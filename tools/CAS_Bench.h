@@ -0,0 +1,67 @@
+//CAS Bench
+//
+// Copyright(c) 2020 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <stdint.h>
+
+// The CAS compile options change the kernels, so 'CAS_BenchVariant.cpp' gets built once per combination of
+// CAS_BETTER_DIAGONALS (bit 0), CAS_SLOW (bit 1) and CAS_GO_SLOWER (bit 2), each exporting a BenchRun<n>().
+#define BENCH_VARIANT_COUNT 8
+
+struct BenchCase
+{
+    // 32-bit float RGBA images with tightly packed rows.
+    const float* src;
+    float* dst;
+    uint32_t inW;
+    uint32_t inH;
+    uint32_t outW;
+    uint32_t outH;
+    float sharpness;
+    uint32_t kernel;
+    uint32_t threads;
+    uint32_t tileW;
+    uint32_t tileH;
+    // Keep timing until both are reached.
+    uint32_t minIterations;
+    double minSeconds;
+};
+
+struct BenchTiming
+{
+    // The kernel that actually ran, lower than asked for if the CPU lacks it.
+    uint32_t kernel;
+    uint32_t iterations;
+    double best;
+    double median;
+};
+
+typedef BenchTiming (*BenchFn)(const BenchCase& c);
+
+struct BenchVariant
+{
+    const char* name;
+    bool betterDiagonals;
+    bool slow;
+    bool goSlower;
+    BenchFn fn;
+};
+
+extern const BenchVariant g_benchVariants[BENCH_VARIANT_COUNT];
@@ -0,0 +1,90 @@
+//CAS Bench
+//
+// Copyright(c) 2020 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Built once per CAS_BENCH_VARIANT (0 to 7), see 'CAS_Bench.h'.
+
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#if CAS_BENCH_VARIANT & 1
+#define CAS_BETTER_DIAGONALS 1
+#endif
+#if CAS_BENCH_VARIANT & 2
+#define CAS_SLOW 1
+#endif
+#if CAS_BENCH_VARIANT & 4
+#define CAS_GO_SLOWER 1
+#endif
+
+#define A_CPU 1
+#if defined(__GNUC__)
+#define A_GCC 1
+#endif
+#include "ffx_a.h"
+#include "ffx_cas.h"
+#include "ffx_cas_cpu.h"
+
+#include "CAS_Bench.h"
+
+#define BENCH_CAT2(a, b) a##b
+#define BENCH_CAT(a, b) BENCH_CAT2(a, b)
+
+// The kernel choice is per translation unit, so it gets set here and not by the caller.
+BenchTiming BENCH_CAT(BenchRun, CAS_BENCH_VARIANT)(const BenchCase& c)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    BenchTiming t = {};
+    t.kernel = CasCpuKernelSet(c.kernel);
+    CasCpuPool pool(c.threads);
+
+    CasCpuImage src = { (void*)c.src, c.inW, c.inH, size_t(c.inW) * 16 };
+    CasCpuImage dst = { c.dst, c.outW, c.outH, size_t(c.outW) * 16 };
+    varAU4(const0);
+    varAU4(const1);
+    CasSetup(const0, const1, c.sharpness, AF1(c.inW), AF1(c.inH), AF1(c.outW), AF1(c.outH));
+    bool noScaling = c.inW == c.outW && c.inH == c.outH;
+    // Phase tables are built once per resolution change in real use, so outside of the timing.
+    CasCpuPhase phase;
+    if (!noScaling)
+        CasCpuPhaseSetup(phase, const0, c.outW, c.outH);
+    const CasCpuPhase* pPhase = noScaling ? nullptr : &phase;
+
+    // One untimed run to fault in the destination and wake the workers.
+    CasCpuFilterTiled(pool, dst, src, const0, const1, noScaling, c.tileW, c.tileH, pPhase);
+
+    std::vector<double> seconds;
+    double total = 0.0;
+    while (seconds.size() < c.minIterations || total < c.minSeconds)
+    {
+        Clock::time_point t0 = Clock::now();
+        CasCpuFilterTiled(pool, dst, src, const0, const1, noScaling, c.tileW, c.tileH, pPhase);
+        double s = std::chrono::duration<double>(Clock::now() - t0).count();
+        seconds.push_back(s);
+        total += s;
+    }
+    std::sort(seconds.begin(), seconds.end());
+    t.iterations = uint32_t(seconds.size());
+    t.best = seconds[0];
+    t.median = seconds[seconds.size() / 2];
+    return t;
+}
@@ -0,0 +1,356 @@
+//CAS CLI
+//
+// Copyright(c) 2020 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Command line front end of the CPU CAS runtime in 'ffx_cas_cpu.h'.
+// Reads and writes PFM, PGM, and PPM images through memory mappings, and prints how long each stage took.
+
+#include <ctype.h>
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+
+#define A_CPU 1
+// All the CAS_BETTER_DIAGONALS, CAS_SLOW and CAS_GO_SLOWER variants, picked with --variant
+#define CAS_CPU_VARIANTS 1
+#if defined(__GNUC__)
+#define A_GCC 1
+#endif
+#include "ffx_a.h"
+#include "ffx_cas.h"
+#include "ffx_cas_cpu.h"
+
+// Indexed by CAS_CPU_TRANSFER_*.
+static const char* s_transformNames[CAS_CPU_TRANSFER_COUNT] = { "linear", "srgb", "gamma2", "gamma22", "pq" };
+
+struct Options
+{
+    const char* input = nullptr;
+    const char* output = nullptr;
+    float sharpness = 0.0f;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t threads = 0;
+    uint32_t kernel = CAS_CPU_KERNEL_COUNT;
+    uint32_t variant = 0;
+    uint32_t transform = CAS_CPU_TRANSFER_LINEAR;
+    uint32_t tileW = 16;
+    uint32_t tileH = 16;
+    uint32_t bits = 0;
+};
+
+//--------------------------------------------------------------------------------------
+//
+// Command line
+//
+//--------------------------------------------------------------------------------------
+static void PrintUsage()
+{
+    printf(
+        "Usage: CAS_Cli [options] <input> <output>\n"
+        "Images are PFM, PGM, or PPM, the output type comes from its extension.\n"
+        "  --sharpness <0-1>    0 is the default with the least ringing, 1 is the most (default 0)\n"
+        "  --size <w>x<h>       Output size, up to 4x the input area (default: the input size)\n"
+        "  --threads <n>        Worker threads, 0 for one per hardware thread (default 0)\n"
+        "  --kernel <name>      auto, scalar, sse4.1, avx2, or avx512 (default auto)\n"
+        "  --variant <list>     Compile option variant, none or a comma separated list of diagonals (CAS_BETTER_DIAGONALS),\n"
+        "                       slow (CAS_SLOW), and slower (CAS_GO_SLOWER) (default none)\n"
+        "  --transform <name>   Input encoding, linear, srgb, gamma2, gamma22, or pq, the output gets the same\n"
+        "                       (default linear), the kernels convert on load and store\n"
+        "  --tile <w>x<h>       Tile size of the work split across threads (default 16x16)\n"
+        "  --bits <8|16>        PGM and PPM output depth (default: the input depth, 8 for PFM input)\n"
+        "  --help               Print this\n");
+}
+
+static bool ParseSize(const char* s, uint32_t* pW, uint32_t* pH)
+{
+    char* end;
+    unsigned long w = strtoul(s, &end, 10);
+    if (*end != 'x' && *end != 'X')
+        return false;
+    unsigned long h = strtoul(end + 1, &end, 10);
+    if (*end != 0 || w == 0 || h == 0 || w > 65536 || h > 65536)
+        return false;
+    *pW = uint32_t(w);
+    *pH = uint32_t(h);
+    return true;
+}
+
+// Variant bits from a list like "diagonals,slower", returns false on an unknown name.
+static bool ParseVariant(const char* s, uint32_t* pVariant)
+{
+    static const char* names[] = { "diagonals", "slow", "slower" };
+    static const uint32_t bits[] = { CAS_CPU_VARIANT_BETTER_DIAGONALS, CAS_CPU_VARIANT_SLOW, CAS_CPU_VARIANT_GO_SLOWER };
+    *pVariant = 0;
+    if (strcmp(s, "none") == 0)
+        return true;
+    while (*s)
+    {
+        size_t n = strcspn(s, ",");
+        uint32_t i = 0;
+        while (i < 3 && (strlen(names[i]) != n || strncmp(s, names[i], n) != 0))
+            i++;
+        if (i == 3)
+            return false;
+        *pVariant |= bits[i];
+        s += n;
+        if (*s == ',')
+            s++;
+    }
+    return true;
+}
+
+// Returns 0 to run, 1 on bad arguments, and 2 after printing the help.
+static int ParseOptions(int argc, char** argv, Options& o)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(a, "--help") == 0 || strcmp(a, "-h") == 0)
+        {
+            PrintUsage();
+            return 2;
+        }
+        if (a[0] != '-' || a[1] != '-')
+        {
+            if (!o.input)
+                o.input = a;
+            else if (!o.output)
+                o.output = a;
+            else
+            {
+                fprintf(stderr, "Unexpected argument '%s'\n", a);
+                return 1;
+            }
+            continue;
+        }
+        if (!v)
+        {
+            fprintf(stderr, "Missing the value of '%s'\n", a);
+            return 1;
+        }
+        i++;
+        bool ok = true;
+        if (strcmp(a, "--sharpness") == 0)
+        {
+            char* end;
+            o.sharpness = strtof(v, &end);
+            ok = *end == 0 && o.sharpness >= 0.0f && o.sharpness <= 1.0f;
+        }
+        else if (strcmp(a, "--size") == 0)
+            ok = ParseSize(v, &o.width, &o.height);
+        else if (strcmp(a, "--threads") == 0)
+        {
+            char* end;
+            o.threads = uint32_t(strtoul(v, &end, 10));
+            ok = *end == 0 && o.threads <= 1024;
+        }
+        else if (strcmp(a, "--kernel") == 0)
+        {
+            o.kernel = strcmp(v, "auto") == 0 ? CAS_CPU_KERNEL_COUNT : CasCpuKernelFromName(v);
+            ok = strcmp(v, "auto") == 0 || o.kernel < CAS_CPU_KERNEL_COUNT;
+        }
+        else if (strcmp(a, "--variant") == 0)
+            ok = ParseVariant(v, &o.variant);
+        else if (strcmp(a, "--transform") == 0)
+        {
+            ok = false;
+            for (uint32_t t = 0; t < CAS_CPU_TRANSFER_COUNT; t++)
+                if (strcmp(v, s_transformNames[t]) == 0)
+                {
+                    o.transform = t;
+                    ok = true;
+                }
+        }
+        else if (strcmp(a, "--tile") == 0)
+            ok = ParseSize(v, &o.tileW, &o.tileH);
+        else if (strcmp(a, "--bits") == 0)
+        {
+            o.bits = uint32_t(atoi(v));
+            ok = o.bits == 8 || o.bits == 16;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option '%s'\n", a);
+            return 1;
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "Bad value '%s' for '%s'\n", v, a);
+            return 1;
+        }
+    }
+    if (!o.input || !o.output)
+    {
+        PrintUsage();
+        return 1;
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// Stage timing
+//
+//--------------------------------------------------------------------------------------
+class StageTimer
+{
+public:
+    StageTimer() : m_start(Clock::now()), m_stage(m_start) {}
+
+    // Print the time since the last stage ended.
+    void Stage(const char* name)
+    {
+        Clock::time_point now = Clock::now();
+        printf("  %-12s %10.3f ms\n", name, Ms(m_stage, now));
+        m_stage = now;
+    }
+
+    void Total()
+    {
+        printf("  %-12s %10.3f ms\n", "total", Ms(m_start, Clock::now()));
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    static double Ms(Clock::time_point a, Clock::time_point b)
+    {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    }
+    Clock::time_point m_start;
+    Clock::time_point m_stage;
+};
+
+//--------------------------------------------------------------------------------------
+//
+// main
+//
+//--------------------------------------------------------------------------------------
+static uint32_t OutputFormat(const Options& o, const CasCpuFile& in, uint32_t* pType)
+{
+    const char* dot = strrchr(o.output, '.');
+    std::string ext = dot ? dot + 1 : "";
+    for (size_t i = 0; i < ext.size(); i++)
+        ext[i] = char(tolower(ext[i]));
+    bool mono = CasCpuFormatMono(in.img.format);
+    uint32_t bits = o.bits;
+    if (bits == 0)
+        bits = (in.img.format == CAS_CPU_FORMAT_R16 || in.img.format == CAS_CPU_FORMAT_RGB16) ? 16 : 8;
+    if (ext == "pfm")
+    {
+        *pType = CAS_CPU_FILE_PFM;
+        return mono ? CAS_CPU_FORMAT_R32F : CAS_CPU_FORMAT_RGB32F;
+    }
+    *pType = CAS_CPU_FILE_PNM;
+    if (ext == "pgm" && mono)
+        return bits == 16 ? CAS_CPU_FORMAT_R16 : CAS_CPU_FORMAT_R8;
+    if (ext == "ppm" && !mono)
+        return bits == 16 ? CAS_CPU_FORMAT_RGB16 : CAS_CPU_FORMAT_RGB8;
+    fprintf(stderr, "Output '%s' must be .pfm or %s for a %s input\n", o.output, mono ? ".pgm" : ".ppm",
+        mono ? "one channel" : "color");
+    return CAS_CPU_FORMAT_PLANAR32F;
+}
+
+int main(int argc, char** argv)
+{
+    Options o;
+    int parsed = ParseOptions(argc, argv, o);
+    if (parsed)
+        return parsed == 2 ? 0 : 1;
+
+    if (o.kernel < CAS_CPU_KERNEL_COUNT)
+    {
+        if (o.kernel > CasCpuKernelSupported())
+        {
+            fprintf(stderr, "Kernel '%s' is not supported on this CPU (best is '%s')\n", CasCpuKernelName(o.kernel),
+                CasCpuKernelName(CasCpuKernelSupported()));
+            return 1;
+        }
+        CasCpuKernelSet(o.kernel);
+    }
+    CasCpuPool pool(o.threads);
+
+    StageTimer timer;
+    CasCpuFile in, out;
+    if (!CasCpuFileOpen(in, o.input))
+    {
+        fprintf(stderr, "Can't read '%s' as a PFM, PGM, or PPM image\n", o.input);
+        return 1;
+    }
+    uint32_t inW = in.img.width, inH = in.img.height;
+    uint32_t outW = o.width ? o.width : inW, outH = o.height ? o.height : inH;
+    if (!CasSupportScaling(AF1(outW), AF1(outH), AF1(inW), AF1(inH)))
+    {
+        fprintf(stderr, "Scaling %ux%u to %ux%u is over the %.1fx area limit\n", inW, inH, outW, outH, CAS_AREA_LIMIT);
+        return 1;
+    }
+    uint32_t type;
+    uint32_t format = OutputFormat(o, in, &type);
+    if (format == CAS_CPU_FORMAT_PLANAR32F)
+        return 1;
+
+    printf("%s %ux%u -> %s %ux%u, kernel %s, variant %u, %u threads, tile %ux%u, transform %s, sharpness %.3f\n",
+        o.input, inW, inH, o.output, outW, outH, CasCpuKernelName(CasCpuKernel()), o.variant, pool.Threads(), o.tileW,
+        o.tileH, s_transformNames[o.transform], o.sharpness);
+    timer.Stage("open");
+
+    if (!CasCpuFileCreate(out, o.output, type, outW, outH, format))
+    {
+        fprintf(stderr, "Can't create '%s'\n", o.output);
+        return 1;
+    }
+    timer.Stage("create");
+
+    varAU4(const0);
+    varAU4(const1);
+    CasSetup(const0, const1, o.sharpness, AF1(inW), AF1(inH), AF1(outW), AF1(outH));
+    bool noScaling = inW == outW && inH == outH;
+    CasCpuPhase phase;
+    if (!noScaling)
+        CasCpuPhaseSetup(phase, const0, outW, outH);
+    timer.Stage("setup");
+
+    // Straight between the mappings, the kernels convert the samples and the transfer on load and store.
+    in.img.transfer = o.transform;
+    out.img.transfer = o.transform;
+    CasCpuFilterTiledVariant(pool, out.img, in.img, const0, const1, noScaling, o.variant, o.tileW, o.tileH,
+        noScaling ? nullptr : &phase);
+    timer.Stage("filter");
+
+    // PFM rows run bottom to top, the other types top to bottom.
+    if (in.bottomUp != out.bottomUp)
+    {
+        CasCpuFileFlip(out);
+        timer.Stage("flip");
+    }
+
+    CasCpuFileClose(in);
+    if (!CasCpuFileClose(out))
+    {
+        fprintf(stderr, "Failed writing '%s'\n", o.output);
+        return 1;
+    }
+    timer.Stage("close");
+    timer.Total();
+    return 0;
+}
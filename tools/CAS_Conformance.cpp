@@ -0,0 +1,1510 @@
+//CAS Conformance
+//
+// Copyright(c) 2020 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Runs every CPU path against a double precision reference of the CasFilter() math, on synthetic and edge case images.
+// Built once per CAS_CONFORMANCE_VARIANT (0 to 7), the same bits as CAS_Bench:
+// CAS_BETTER_DIAGONALS (bit 0), CAS_SLOW (bit 1) and CAS_GO_SLOWER (bit 2).
+// Exits with 1 when any path is outside its tolerance, so each variant is a test and a post build step.
+
+#include <stdint.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if CAS_CONFORMANCE_VARIANT & 1
+#define CAS_BETTER_DIAGONALS 1
+#endif
+#if CAS_CONFORMANCE_VARIANT & 2
+#define CAS_SLOW 1
+#endif
+#if CAS_CONFORMANCE_VARIANT & 4
+#define CAS_GO_SLOWER 1
+#endif
+
+#define A_CPU 1
+// CasCpuFilterVariant() with the variant of this build must match CasCpuFilter()
+#define CAS_CPU_VARIANTS 1
+#if defined(__GNUC__)
+#define A_GCC 1
+#endif
+#include "ffx_a.h"
+#include "ffx_cas.h"
+#include "ffx_cas_cpu.h"
+
+static const char* const s_variantNames[8] =
+{
+    "default",
+    "better_diagonals",
+    "slow",
+    "better_diagonals+slow",
+    "go_slower",
+    "better_diagonals+go_slower",
+    "slow+go_slower",
+    "better_diagonals+slow+go_slower",
+};
+
+// 8-bit RGBA for the fixed point path, gamma 2.0 encoded, not one of the CAS_CPU_FORMAT_* formats.
+#define FORMAT_RGBA8 100
+
+//--------------------------------------------------------------------------------------
+//
+// Reference
+//
+//--------------------------------------------------------------------------------------
+// CasFilter() in double precision.
+// The APrx*() approximations are part of the CasFilter() math unless CAS_GO_SLOWER is defined, so they are kept,
+// evaluated on their argument rounded to float like the shader does, with the rest of the math in double.
+// Sample positions are computed in float too, so both sides pick the same source texels.
+struct RefImage
+{
+    uint32_t w;
+    uint32_t h;
+    std::vector<double> px;
+
+    const double* At(int32_t x, int32_t y) const
+    {
+        x = std::min(std::max(x, 0), int32_t(w) - 1);
+        y = std::min(std::max(y, 0), int32_t(h) - 1);
+        return &px[(size_t(y) * w + x) * 4];
+    }
+};
+
+// NaN saturates to 0, as on the GPU and in ASatF1().
+static double RefSat(double a)
+{
+    return a > 0.0 ? (a < 1.0 ? a : 1.0) : 0.0;
+}
+
+// In float the reciprocal of a maximum under 1/FLT_MAX (decoded denormals) overflows to infinity.
+static double RefLoRcp(double a)
+{
+#ifdef CAS_GO_SLOWER
+    return a < 1.0 / FLT_MAX ? INFINITY : 1.0 / a;
+#else
+    return APrxLoRcpF1(AF1(a));
+#endif
+}
+
+static double RefLoSqrt(double a)
+{
+#ifdef CAS_GO_SLOWER
+    return sqrt(a);
+#else
+    return APrxLoSqrtF1(AF1(a));
+#endif
+}
+
+// The estimate comes from the float bits, the Newton step is done in double.
+static double RefMedRcp(double a)
+{
+#ifdef CAS_GO_SLOWER
+    return 1.0 / a;
+#else
+    double b = AF1_AU1(AU1_(0x7ef19fff) - AU1_AF1(AF1(a)));
+    return b * (2.0 - b * a);
+#endif
+}
+
+static double Min3(double a, double b, double c)
+{
+    return std::min(a, std::min(b, c));
+}
+
+static double Max3(double a, double b, double c)
+{
+    return std::max(a, std::max(b, c));
+}
+
+// Soft min and max of channel 'k' around tap 't[1][1]' of a 3x3 window, then the weight of that no-scaling result.
+static double RefWeight(const double* t[3][3], uint32_t k, double peak, double* pMn, double* pMx)
+{
+    double mn = Min3(Min3(t[0][1][k], t[1][0][k], t[1][1][k]), t[1][2][k], t[2][1][k]);
+    double mx = Max3(Max3(t[0][1][k], t[1][0][k], t[1][1][k]), t[1][2][k], t[2][1][k]);
+#ifdef CAS_BETTER_DIAGONALS
+    mn = mn + Min3(Min3(mn, t[0][0][k], t[0][2][k]), t[2][0][k], t[2][2][k]);
+    mx = mx + Max3(Max3(mx, t[0][0][k], t[0][2][k]), t[2][0][k], t[2][2][k]);
+    double lim = 2.0;
+#else
+    double lim = 1.0;
+#endif
+    if (pMn)
+        *pMn = mn;
+    if (pMx)
+        *pMx = mx;
+    return RefLoSqrt(RefSat(std::min(mn, lim - mx) * RefLoRcp(mx))) * peak;
+}
+
+// One output pixel, 'pix' is RGBA after the saturate, 'raw' is RGB before it.
+// With scaling, alpha is point sampled, and positions within rounding of a texel edge may land on either side of it.
+// The alphas of all the texels it could be are in 'alpha'.
+struct RefPixel
+{
+    double pix[4];
+    double raw[3];
+    double alpha[4];
+    uint32_t alphas;
+};
+
+static void RefFilter(RefPixel& rp, const RefImage& img, uint32_t ipX, uint32_t ipY, const uint32_t* const0,
+    const uint32_t* const1, bool noScaling)
+{
+    double* pix = rp.pix;
+    double* raw = rp.raw;
+    double peak = AF1_AU1(const1[0]);
+    if (noScaling)
+    {
+        const double* t[3][3];
+        for (int32_t j = 0; j < 3; j++)
+            for (int32_t i = 0; i < 3; i++)
+                t[j][i] = img.At(int32_t(ipX) + i - 1, int32_t(ipY) + j - 1);
+        double wt[3];
+        for (uint32_t k = 0; k < 3; k++)
+            wt[k] = RefWeight(t, k, peak, nullptr, nullptr);
+        for (uint32_t k = 0; k < 3; k++)
+        {
+#ifdef CAS_SLOW
+            double w = wt[k];
+#else
+            double w = wt[1];
+#endif
+            raw[k] = (t[0][1][k] * w + t[1][0][k] * w + t[1][2][k] * w + t[2][1][k] * w + t[1][1][k]) *
+                RefMedRcp(1.0 + 4.0 * w);
+            pix[k] = RefSat(raw[k]);
+        }
+        pix[3] = t[1][1][3];
+        rp.alpha[0] = pix[3];
+        rp.alphas = 1;
+        return;
+    }
+
+    AF1 ppX = AF1(ipX) * AF1_AU1(const0[0]) + AF1_AU1(const0[2]);
+    AF1 ppY = AF1(ipY) * AF1_AU1(const0[1]) + AF1_AU1(const0[3]);
+    AF1 fpX = floorf(ppX);
+    AF1 fpY = floorf(ppY);
+    double fx = double(ppX) - double(fpX);
+    double fy = double(ppY) - double(fpY);
+    int32_t x = int32_t(fpX), y = int32_t(fpY);
+    //  a b c d
+    //  e f g h
+    //  i j k l
+    //  m n o p
+    const double* t[4][4];
+    for (int32_t j = 0; j < 4; j++)
+        for (int32_t i = 0; i < 4; i++)
+            t[j][i] = img.At(x + i - 1, y + j - 1);
+    // Weights and green soft min and max of the 4 no-scaling results {f,g,j,k}.
+    double w[4][3], mn[4], mx[4];
+    for (uint32_t r = 0; r < 4; r++)
+    {
+        uint32_t cy = 1 + (r >> 1), cx = 1 + (r & 1);
+        const double* n[3][3];
+        for (uint32_t j = 0; j < 3; j++)
+            for (uint32_t i = 0; i < 3; i++)
+                n[j][i] = t[cy + j - 1][cx + i - 1];
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            double kMn, kMx;
+            w[r][k] = RefWeight(n, k, peak, &kMn, &kMx);
+            if (k == 1)
+            {
+                mn[r] = kMn;
+                mx[r] = kMx;
+            }
+        }
+    }
+    // Bilinear blend, thinned on edges.
+    double bl[4] = { (1.0 - fx) * (1.0 - fy), fx * (1.0 - fy), (1.0 - fx) * fy, fx * fy };
+    for (uint32_t r = 0; r < 4; r++)
+        bl[r] *= RefLoRcp(1.0 / 32.0 + (mx[r] - mn[r]));
+    double s = bl[0], u = bl[2], v = bl[3];
+    double tt = bl[1];
+    for (uint32_t k = 0; k < 3; k++)
+    {
+#ifdef CAS_SLOW
+        uint32_t q = k;
+#else
+        uint32_t q = 1;
+#endif
+        double wf = w[0][q], wg = w[1][q], wj = w[2][q], wk = w[3][q];
+        double qbe = wf * s;
+        double qch = wg * tt;
+        double qf = wg * tt + wj * u + s;
+        double qg = wf * s + wk * v + tt;
+        double qj = wf * s + wk * v + u;
+        double qk = wg * tt + wj * u + v;
+        double qin = wj * u;
+        double qlo = wk * v;
+        double rcpW = RefMedRcp(2.0 * qbe + 2.0 * qch + 2.0 * qin + 2.0 * qlo + qf + qg + qj + qk);
+        raw[k] = (t[0][1][k] * qbe + t[1][0][k] * qbe + t[0][2][k] * qch + t[1][3][k] * qch + t[2][0][k] * qin +
+            t[3][1][k] * qin + t[2][3][k] * qlo + t[3][2][k] * qlo + t[1][1][k] * qf + t[1][2][k] * qg +
+            t[2][1][k] * qj + t[2][2][k] * qk) * rcpW;
+        pix[k] = RefSat(raw[k]);
+    }
+    pix[3] = t[1][1][3];
+    const double edge = 1.0 / 1024.0;
+    int32_t ex = fx < edge ? -1 : (fx > 1.0 - edge ? 1 : 0);
+    int32_t ey = fy < edge ? -1 : (fy > 1.0 - edge ? 1 : 0);
+    rp.alphas = 0;
+    for (int32_t j = 0; j < 2; j++)
+        for (int32_t i = 0; i < 2; i++)
+            if ((i == 0 || ex) && (j == 0 || ey))
+                rp.alpha[rp.alphas++] = img.At(x + i * ex, y + j * ey)[3];
+}
+
+// Alpha as the output format stores it, half clamps past 65504 (INF and NaN too) as AU1_AH1_AF1() does.
+static double RefAlpha(uint32_t format, double a)
+{
+    return format == CAS_CPU_FORMAT_RGBA16F ? AF1_AH1_AU1(AU1_AH1_AF1(AF1(a))) : a;
+}
+
+// Rec.2020 to Rec.709 (ITU-R BT.2087) times 'maxNits/80' on the color of 'rp', as CasCpuMatrixScRgb() does.
+static void RefScRgb(RefPixel& rp, double maxNits)
+{
+    static const double m[3][3] =
+    {
+        { 1.660491, -0.587641, -0.072850 },
+        { -0.124550, 1.132900, -0.008349 },
+        { -0.018151, -0.100579, 1.118730 },
+    };
+    double c[3] = { rp.pix[0], rp.pix[1], rp.pix[2] };
+    for (uint32_t k = 0; k < 3; k++)
+        rp.pix[k] = (m[k][0] * c[0] + m[k][1] * c[1] + m[k][2] * c[2]) * (maxNits / 80.0);
+}
+
+//--------------------------------------------------------------------------------------
+//
+// Corpus
+//
+//--------------------------------------------------------------------------------------
+static uint32_t Hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+static float Noise(uint32_t x, uint32_t y, uint32_t c)
+{
+    return float(Hash((y * 4096u + x) * 4u + c) >> 8) * (1.0f / 16777215.0f);
+}
+
+typedef float (*GenFn)(uint32_t x, uint32_t y, uint32_t c, uint32_t w, uint32_t h);
+
+static float GenBlack(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) { return 0.0f; }
+static float GenWhite(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) { return 1.0f; }
+static float GenGrey(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) { return 0.5f; }
+static float GenNoise(uint32_t x, uint32_t y, uint32_t c, uint32_t, uint32_t) { return Noise(x, y, c); }
+
+static float GenRamps(uint32_t x, uint32_t y, uint32_t c, uint32_t w, uint32_t h)
+{
+    return float(c == 0 ? x : (c == 1 ? y : x + y)) / float(std::max(c == 0 ? w - 1 : (c == 1 ? h - 1 : w + h - 2), 1u));
+}
+
+static float GenChecker(uint32_t x, uint32_t y, uint32_t, uint32_t, uint32_t)
+{
+    return float((x ^ y) & 1);
+}
+
+// Isolated full range pixels, the largest sharpening overshoot.
+static float GenImpulses(uint32_t x, uint32_t y, uint32_t c, uint32_t w, uint32_t h)
+{
+    bool corner = (x == 0 || x == w - 1) && (y == 0 || y == h - 1);
+    return corner || (Hash(y * 4096u + x) & 15u) == 0u ? (c == 2 ? 0.25f : 1.0f) : 0.0f;
+}
+
+// One texel wide horizontal, vertical and diagonal lines.
+static float GenLines(uint32_t x, uint32_t y, uint32_t c, uint32_t, uint32_t)
+{
+    bool line = x % 7 == 3 || y % 9 == 4 || (x + 2 * y) % 13 == 0;
+    return line ? (c == 0 ? 0.9f : 0.8f) : 0.1f;
+}
+
+// Tiny maximums, where rcp() of the max is at its largest.
+static float GenNearBlack(uint32_t x, uint32_t y, uint32_t c, uint32_t, uint32_t)
+{
+    return Noise(x, y, c) * (1.0f / 4096.0f);
+}
+
+static float GenNearWhite(uint32_t x, uint32_t y, uint32_t c, uint32_t, uint32_t)
+{
+    return 1.0f - Noise(x, y, c) * (1.0f / 4096.0f);
+}
+
+// Float denormals next to zero, normal minimums and ones.
+static float GenDenormals(uint32_t x, uint32_t y, uint32_t c, uint32_t, uint32_t)
+{
+    static const float values[4] = { 0.0f, 1e-40f, 1.17549435e-38f, 1.0f };
+    return values[Hash((y * 4096u + x) * 4u + c) & 3u];
+}
+
+// Alpha past the half range, infinities and NaN, which every store of alpha must keep or clamp as the scalar one does.
+static float GenOverflowAlpha(uint32_t x, uint32_t y, uint32_t c, uint32_t, uint32_t)
+{
+    static const float values[8] = { INFINITY, -INFINITY, NAN, -NAN, 65504.0f, 65520.0f, -1e5f, 0.5f };
+    uint32_t i = Hash((y * 4096u + x) * 4u + c);
+    return i & 8u ? Noise(x, y, c) : values[i & 7u];
+}
+
+struct Corpus
+{
+    const char* name;
+    uint32_t w;
+    uint32_t h;
+    GenFn fn;
+    // Alpha, noise when null.
+    GenFn alpha;
+};
+
+// Odd sizes, so every kernel runs its vector tails and the tiles are partial.
+static const Corpus s_corpus[] =
+{
+    { "black", 19, 11, GenBlack },
+    { "white", 19, 11, GenWhite },
+    { "grey", 19, 11, GenGrey },
+    { "noise", 67, 45, GenNoise },
+    { "ramps", 67, 45, GenRamps },
+    { "checker", 33, 21, GenChecker },
+    { "impulses", 41, 29, GenImpulses },
+    { "lines", 41, 29, GenLines },
+    { "near_black", 37, 23, GenNearBlack },
+    { "near_white", 37, 23, GenNearWhite },
+    { "denormals", 9, 7, GenDenormals },
+    { "pixel", 1, 1, GenNoise },
+    { "row", 67, 1, GenNoise },
+    { "column", 1, 45, GenNoise },
+    { "2x2", 2, 2, GenNoise },
+    { "overflow", 41, 13, GenNoise, GenOverflowAlpha },
+};
+
+struct Scale
+{
+    const char* image;
+    uint32_t outW;
+    uint32_t outH;
+};
+
+// Up to the CAS_AREA_LIMIT of 4, uneven ratios, a slight downscale, and single texel inputs.
+static const Scale s_scales[] =
+{
+    { "noise", 100, 67 },
+    { "noise", 134, 90 },
+    { "noise", 50, 34 },
+    { "ramps", 89, 60 },
+    { "checker", 57, 37 },
+    { "impulses", 77, 51 },
+    { "lines", 61, 43 },
+    { "near_black", 55, 34 },
+    { "denormals", 17, 13 },
+    { "pixel", 3, 2 },
+    { "row", 100, 2 },
+    { "2x2", 5, 5 },
+    { "overflow", 67, 29 },
+};
+
+static const float s_sharpness[] = { 0.0f, 0.5f, 1.0f };
+
+struct Case
+{
+    const Corpus* image;
+    uint32_t outW;
+    uint32_t outH;
+    float sharpness;
+    std::string name;
+};
+
+static std::vector<Case> Cases()
+{
+    std::vector<Case> cases;
+    char name[128];
+    for (const Corpus& c : s_corpus)
+        for (float s : s_sharpness)
+        {
+            snprintf(name, sizeof(name), "%s %ux%u sharpness %.1f", c.name, c.w, c.h, s);
+            cases.push_back({ &c, c.w, c.h, s, name });
+        }
+    for (const Scale& sc : s_scales)
+        for (const Corpus& c : s_corpus)
+            if (!strcmp(c.name, sc.image))
+                for (float s : s_sharpness)
+                {
+                    snprintf(name, sizeof(name), "%s %ux%u->%ux%u sharpness %.1f", c.name, c.w, c.h, sc.outW, sc.outH, s);
+                    cases.push_back({ &c, sc.outW, sc.outH, s, name });
+                }
+    return cases;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// Images in the runtime formats
+//
+//--------------------------------------------------------------------------------------
+// Each surface is its own allocation of exactly its size, so reads or writes past the end show up under ASan.
+struct Surface
+{
+    std::vector<uint8_t> mem;
+    std::vector<float> planes[4];
+    CasCpuImage img;
+    uint32_t format;
+};
+
+static void SurfaceInit(Surface& s, uint32_t format, uint32_t w, uint32_t h)
+{
+    s.format = format;
+    if (format == CAS_CPU_FORMAT_PLANAR32F)
+    {
+        for (uint32_t c = 0; c < 4; c++)
+            s.planes[c].assign(size_t(w) * h, 0.0f);
+        s.img = CasCpuImagePlanar(s.planes[0].data(), s.planes[1].data(), s.planes[2].data(), s.planes[3].data(), w, h,
+            size_t(w) * 4);
+        return;
+    }
+    size_t pitch = size_t(w) * (format == FORMAT_RGBA8 ? 4 : CasCpuFormatBytes(format));
+    s.mem.assign(pitch * h, 0);
+    s.img = { s.mem.data(), w, h, pitch };
+    s.img.format = format == FORMAT_RGBA8 ? CAS_CPU_FORMAT_RGBA32F : format;
+}
+
+// RGBA8 stores the values as codes, the same as the other 8-bit formats.
+static void SurfaceStore(const Surface& s, uint32_t x, uint32_t y, const float* v)
+{
+    if (s.format == FORMAT_RGBA8)
+    {
+        uint8_t* p = (uint8_t*)CasCpuRowW(s.img, y) + x * 4;
+        for (uint32_t c = 0; c < 4; c++)
+            p[c] = uint8_t(ASatF1(v[c]) * 255.0f + 0.5f);
+        return;
+    }
+    AF1* pr[4];
+    CasCpuTexelSt(CasCpuRowAt(s.img, 0, y, pr), s.img.format, x, v);
+}
+
+// RGBA8 loads the codes over 255, the encoded values.
+static void SurfaceLoad(const Surface& s, uint32_t x, uint32_t y, float* v)
+{
+    if (s.format == FORMAT_RGBA8)
+    {
+        const uint8_t* p = (const uint8_t*)CasCpuRow(s.img, y) + x * 4;
+        for (uint32_t c = 0; c < 4; c++)
+            v[c] = float(p[c]) * (1.0f / 255.0f);
+        return;
+    }
+    AF1* pr[4];
+    CasCpuTexelLd(v, CasCpuRowAt(s.img, 0, y, pr), s.img.format, x);
+}
+
+//--------------------------------------------------------------------------------------
+//
+// Metrics
+//
+//--------------------------------------------------------------------------------------
+// Distance in representable values of the output format.
+#define ULP_BUCKETS 6
+static const char* const s_ulpBucketNames[ULP_BUCKETS] = { "0", "1", "2-3", "4-15", "16-255", "256+" };
+
+static uint32_t UlpBucket(uint64_t ulp)
+{
+    return ulp == 0 ? 0 : (ulp == 1 ? 1 : (ulp < 4 ? 2 : (ulp < 16 ? 3 : (ulp < 256 ? 4 : 5))));
+}
+
+static int64_t FloatOrder(float f)
+{
+    int32_t i;
+    memcpy(&i, &f, 4);
+    return i < 0 ? -int64_t(i & 0x7fffffff) : int64_t(i);
+}
+
+static int64_t HalfOrder(uint32_t h)
+{
+    return (h & 0x8000u) ? -int64_t(h & 0x7fffu) : int64_t(h);
+}
+
+// Equal values, infinities of the same sign and any two NaN are exact, NaN against a number is an infinite error.
+static double AbsError(double out, double ref)
+{
+    if (out == ref || (!(out == out) && !(ref == ref)))
+        return 0.0;
+    double e = fabs(out - ref);
+    return e == e ? e : INFINITY;
+}
+
+static uint64_t UlpDistance(uint32_t format, double out, double ref)
+{
+    if (!(out == out) && !(ref == ref))
+        return 0;
+    if (!(out == out) || !(ref == ref))
+        return UINT64_MAX;
+    int64_t d;
+    switch (format)
+    {
+    case CAS_CPU_FORMAT_RGBA16F:
+        d = HalfOrder(CasCpuHBits(AF1(out))) - HalfOrder(CasCpuHBits(CasCpuHRnd(AF1(ref))));
+        break;
+    case CAS_CPU_FORMAT_R8:
+    case CAS_CPU_FORMAT_RGB8:
+    case FORMAT_RGBA8:
+        d = llround(out * 255.0) - llround(ref * 255.0);
+        break;
+    case CAS_CPU_FORMAT_R16:
+    case CAS_CPU_FORMAT_RGB16:
+        d = llround(out * 65535.0) - llround(ref * 65535.0);
+        break;
+    default:
+        d = FloatOrder(AF1(out)) - FloatOrder(AF1(ref));
+        break;
+    }
+    return uint64_t(d < 0 ? -d : d);
+}
+
+struct Stats
+{
+    uint32_t cases = 0;
+    double maxAbs = 0.0;
+    std::string maxAbsCase;
+    double minPsnr = INFINITY;
+    std::string minPsnrCase;
+    uint64_t ulp[ULP_BUCKETS] = {};
+    // Pixels where the reference saturated a channel, and where the path did too.
+    uint64_t refClipped = 0;
+    uint64_t clipped = 0;
+};
+
+//--------------------------------------------------------------------------------------
+//
+// Paths
+//
+//--------------------------------------------------------------------------------------
+enum PathKind
+{
+    PATH_CPU_REFERENCE, // CasFilterImageCpu() in 'ffx_cas.h'
+    PATH_FILTER,        // CasCpuFilter() on one kernel
+    PATH_TILED,         // CasCpuFilterTiled() with phase tables
+    PATH_POLICY,        // CasCpuFilterTiledPolicy() with the RGBA16F policies
+    PATH_STREAM,        // CasCpuStreamPush()
+    PATH_RGBA8,         // CasCpuFilterRgba8()
+    PATH_PACKED,        // CasCpuFilterH()
+    PATH_BATCH,         // CasCpuFilterBatch() over BATCH_FRAMES copies of the source
+    PATH_YUV,           // CasCpuFilterYuv() on the luma plane
+    PATH_CONVERT,       // CasCpuConvert() to planar, CasCpuFilter(), CasCpuConvert() back
+    PATH_VARIANT,       // CasCpuFilterVariant() and CasCpuFilterTiledVariant() with CAS_CONFORMANCE_VARIANT
+};
+
+// Frames of PATH_BATCH, frame 0 is compared with the reference and the others must match it bit for bit.
+#define BATCH_FRAMES 3
+
+struct Path
+{
+    std::string name;
+    // Group of the tolerance table.
+    const char* group;
+    PathKind kind;
+    uint32_t kernel;
+    uint32_t inFormat;
+    uint32_t outFormat;
+    bool scaling;
+    // CAS_CPU_TRANSFER_* of both images.
+    uint32_t transfer;
+    // Output matrix of CasCpuMatrixScRgb() on the destination, 0 for none.
+    float maxNits;
+};
+
+static const struct
+{
+    const char* name;
+    uint32_t format;
+} s_formats[] =
+{
+    { "rgba32f", CAS_CPU_FORMAT_RGBA32F },
+    { "rgba16f", CAS_CPU_FORMAT_RGBA16F },
+    { "planar32f", CAS_CPU_FORMAT_PLANAR32F },
+    { "r8", CAS_CPU_FORMAT_R8 },
+    { "r16", CAS_CPU_FORMAT_R16 },
+    { "r32f", CAS_CPU_FORMAT_R32F },
+    { "rgb32f", CAS_CPU_FORMAT_RGB32F },
+    { "rgb8", CAS_CPU_FORMAT_RGB8 },
+    { "rgb16", CAS_CPU_FORMAT_RGB16 },
+};
+
+// Encoded images, one per way the kernels decode them (8-bit, 16-bit and half tables, the cubic on floats).
+static const struct
+{
+    const char* name;
+    uint32_t format;
+    uint32_t transfer;
+} s_transfers[] =
+{
+    { "srgb8", CAS_CPU_FORMAT_RGB8, CAS_CPU_TRANSFER_SRGB },
+    { "pq16", CAS_CPU_FORMAT_RGB16, CAS_CPU_TRANSFER_PQ },
+    { "gamma22f16", CAS_CPU_FORMAT_RGBA16F, CAS_CPU_TRANSFER_GAMMA22 },
+    { "srgbf32", CAS_CPU_FORMAT_RGBA32F, CAS_CPU_TRANSFER_SRGB },
+    { "gamma2f32", CAS_CPU_FORMAT_R32F, CAS_CPU_TRANSFER_GAMMA2 },
+};
+
+static std::vector<Path> Paths()
+{
+    std::vector<Path> paths;
+    paths.push_back({ "CasFilterCpu", "CasFilterCpu", PATH_CPU_REFERENCE, 0, CAS_CPU_FORMAT_RGBA32F,
+        CAS_CPU_FORMAT_RGBA32F, true, CAS_CPU_TRANSFER_LINEAR, 0.0f });
+    for (uint32_t k = 0; k < CAS_CPU_KERNEL_COUNT; k++)
+    {
+        std::string kernel = std::string("/") + CasCpuKernelName(k);
+        for (const auto& f : s_formats)
+            paths.push_back({ f.name + kernel, f.name, PATH_FILTER, k, f.format, f.format, true,
+                CAS_CPU_TRANSFER_LINEAR, 0.0f });
+        for (const auto& t : s_transfers)
+            paths.push_back({ t.name + kernel, t.name, PATH_FILTER, k, t.format, t.format, true, t.transfer,
+                0.0f });
+        paths.push_back({ "scrgb" + kernel, "scrgb", PATH_FILTER, k, CAS_CPU_FORMAT_RGBA32F, CAS_CPU_FORMAT_RGBA32F, true,
+            CAS_CPU_TRANSFER_LINEAR, 1000.0f });
+        paths.push_back({ "tiled" + kernel, "tiled", PATH_TILED, k, CAS_CPU_FORMAT_RGBA32F, CAS_CPU_FORMAT_RGBA32F, true,
+            CAS_CPU_TRANSFER_LINEAR, 0.0f });
+        paths.push_back({ "policy" + kernel, "policy", PATH_POLICY, k, CAS_CPU_FORMAT_RGBA16F, CAS_CPU_FORMAT_RGBA16F,
+            true, CAS_CPU_TRANSFER_LINEAR, 0.0f });
+        paths.push_back({ "stream" + kernel, "stream", PATH_STREAM, k, CAS_CPU_FORMAT_RGBA32F, CAS_CPU_FORMAT_RGBA32F,
+            false, CAS_CPU_TRANSFER_LINEAR, 0.0f });
+        paths.push_back({ "rgba8" + kernel, "rgba8", PATH_RGBA8, k, FORMAT_RGBA8, FORMAT_RGBA8, false,
+            CAS_CPU_TRANSFER_LINEAR, 0.0f });
+        paths.push_back({ "batch" + kernel, "batch", PATH_BATCH, k, CAS_CPU_FORMAT_RGBA32F, CAS_CPU_FORMAT_RGBA32F, true,
+            CAS_CPU_TRANSFER_LINEAR, 0.0f });
+        paths.push_back({ "yuv8" + kernel, "yuv8", PATH_YUV, k, CAS_CPU_FORMAT_R8, CAS_CPU_FORMAT_R8, true,
+            CAS_CPU_TRANSFER_LINEAR, 0.0f });
+        paths.push_back({ "yuv16" + kernel, "yuv16", PATH_YUV, k, CAS_CPU_FORMAT_R16, CAS_CPU_FORMAT_R16, true,
+            CAS_CPU_TRANSFER_LINEAR, 0.0f });
+        paths.push_back({ "variant" + kernel, "variant", PATH_VARIANT, k, CAS_CPU_FORMAT_RGBA32F, CAS_CPU_FORMAT_RGBA32F,
+            true, CAS_CPU_TRANSFER_LINEAR, 0.0f });
+        paths.push_back({ "convert" + kernel, "convert", PATH_CONVERT, k, CAS_CPU_FORMAT_RGB8, CAS_CPU_FORMAT_RGB8, true,
+            CAS_CPU_TRANSFER_SRGB, 0.0f });
+        // Float sources into half, where the half stores meet values past 65504.
+        paths.push_back({ "rgba16f_32f" + kernel, "rgba16f", PATH_FILTER, k, CAS_CPU_FORMAT_RGBA32F,
+            CAS_CPU_FORMAT_RGBA16F, true, CAS_CPU_TRANSFER_LINEAR, 0.0f });
+        paths.push_back({ "convert16f" + kernel, "convert16f", PATH_CONVERT, k, CAS_CPU_FORMAT_RGBA32F,
+            CAS_CPU_FORMAT_RGBA16F, true, CAS_CPU_TRANSFER_LINEAR, 0.0f });
+    }
+    paths.push_back({ "packed", "packed", PATH_PACKED, 0, CAS_CPU_FORMAT_RGBA32F, CAS_CPU_FORMAT_RGBA16F, true,
+        CAS_CPU_TRANSFER_LINEAR, 0.0f });
+    return paths;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// Tolerances
+//
+//--------------------------------------------------------------------------------------
+// Largest absolute error on any channel, and lowest PSNR of any case, in the output encoding (0 to 1).
+// A path which refuses the images, or whose copies of one result differ, fails with an infinite error.
+// The float paths differ from the reference only by float rounding and FMA, the quantized ones add half a code,
+// RGBA8 is within one code (see its "ERROR BOUND"), and the packed path runs in half with its own approximations.
+// Encoded images add the error of the cubic in "TRANSFER FUNCTIONS" and of float rounding, times the slope of the
+// encode, which for PQ is steep near black. The scRGB output matrix scales the float error by up to 1000/80.
+struct Tolerance
+{
+    const char* group;
+    double maxAbs;
+    double minPsnr;
+};
+
+static const Tolerance s_tolerances[] =
+{
+    { "CasFilterCpu", 2e-6, 125.0 },
+    { "rgba32f", 2e-6, 125.0 },
+    { "planar32f", 2e-6, 125.0 },
+    { "r32f", 2e-6, 125.0 },
+    { "rgb32f", 2e-6, 125.0 },
+    { "tiled", 2e-6, 125.0 },
+    { "stream", 2e-6, 125.0 },
+    { "batch", 2e-6, 125.0 },
+    { "variant", 2e-6, 125.0 },
+    { "rgba16f", 1e-3, 60.0 },
+    { "policy", 1e-3, 60.0 },
+    { "r16", 1.2e-5, 95.0 },
+    { "rgb16", 1.2e-5, 95.0 },
+    { "yuv16", 1.2e-5, 95.0 },
+    { "r8", 2.5e-3, 50.0 },
+    { "rgb8", 2.5e-3, 50.0 },
+    { "yuv8", 2.5e-3, 50.0 },
+    { "scrgb", 4e-5, 110.0 },
+    { "srgb8", 2.5e-3, 50.0 },
+    { "convert", 2.5e-3, 50.0 },
+    { "convert16f", 1e-3, 60.0 },
+    { "pq16", 1e-4, 95.0 },
+    { "gamma22f16", 1e-3, 60.0 },
+    { "srgbf32", 3e-5, 120.0 },
+    { "gamma2f32", 4e-6, 120.0 },
+#ifdef CAS_BETTER_DIAGONALS
+    { "rgba8", 3.5 / 255.0, 50.0 },
+#else
+    { "rgba8", 1.1 / 255.0, 50.0 },
+#endif
+    { "packed", 1e-2, 48.0 },
+};
+
+static const Tolerance* FindTolerance(const char* group)
+{
+    for (const Tolerance& t : s_tolerances)
+        if (!strcmp(t.group, group))
+            return &t;
+    return nullptr;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// Running a path on a case
+//
+//--------------------------------------------------------------------------------------
+static void RunPath(const Path& p, const Case& c, CasCpuPool& pool, Stats& st, bool verbose)
+{
+    uint32_t inW = c.image->w, inH = c.image->h, outW = c.outW, outH = c.outH;
+    bool noScaling = inW == outW && inH == outH;
+    varAU4(const0);
+    varAU4(const1);
+    CasSetup(const0, const1, c.sharpness, AF1(inW), AF1(inH), AF1(outW), AF1(outH));
+
+    // Source in the path's format, and what the filter sees of it, in linear.
+    Surface src;
+    SurfaceInit(src, p.inFormat, inW, inH);
+    src.img.transfer = p.transfer;
+    RefImage seen = { inW, inH, std::vector<double>(size_t(inW) * inH * 4) };
+    for (uint32_t y = 0; y < inH; y++)
+        for (uint32_t x = 0; x < inW; x++)
+        {
+            float v[4];
+            for (uint32_t k = 0; k < 3; k++)
+                v[k] = c.image->fn(x, y, k, inW, inH);
+            v[3] = c.image->alpha ? c.image->alpha(x, y, 3, inW, inH) : Noise(x, y, 3);
+            SurfaceStore(src, x, y, v);
+            SurfaceLoad(src, x, y, v);
+            double* s = &seen.px[(size_t(y) * inW + x) * 4];
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                s[k] = v[k];
+                if (p.kind == PATH_PACKED)
+                    s[k] = CasCpuHRnd(v[k]);
+                if (p.kind == PATH_RGBA8 && k < 3)
+                    s[k] = s[k] * s[k];
+                // Decoded to linear in float, as the kernels hold it.
+                if (k < 3)
+                    s[k] = float(CasCpuTransferDecodeD(p.transfer, s[k]));
+            }
+        }
+
+    Surface dst;
+    SurfaceInit(dst, p.outFormat, outW, outH);
+    dst.img.transfer = p.transfer;
+    CasCpuMatrixConst matrix = CasCpuMatrixScRgb(p.maxNits);
+    if (p.maxNits != 0.0f)
+        dst.img.matrix = &matrix;
+    bool failed = false;
+    switch (p.kind)
+    {
+    case PATH_CPU_REFERENCE:
+        CasFilterImageCpu((AF1*)dst.mem.data(), outW * 4, outW, outH, (const AF1*)src.mem.data(), inW * 4, inW, inH, const0,
+            const1, noScaling);
+        break;
+    case PATH_FILTER:
+        CasCpuFilter(dst.img, src.img, const0, const1, noScaling);
+        break;
+    case PATH_TILED:
+    {
+        CasCpuPhase phase;
+        if (!noScaling)
+            CasCpuPhaseSetup(phase, const0, outW, outH);
+        CasCpuFilterTiled(pool, dst.img, src.img, const0, const1, noScaling, 7, 5, noScaling ? nullptr : &phase);
+        break;
+    }
+    case PATH_POLICY:
+    {
+        CasCpuPhase phase;
+        if (!noScaling)
+            CasCpuPhaseSetup(phase, const0, outW, outH);
+        CasCpuFilterTiledPolicy<CasCpuPolicyRgba16F, CasCpuInputNone, CasCpuPolicyRgba16F>(pool, dst.img, src.img, const0,
+            const1, noScaling, 7, 5, noScaling ? nullptr : &phase);
+        break;
+    }
+    case PATH_STREAM:
+    {
+        CasCpuStream stream;
+        CasCpuStreamInit(stream, inW, const1);
+        uint32_t out = 0;
+        for (uint32_t y = 0; y < inH; y++)
+            if (CasCpuStreamPush(stream, CasCpuRow(src.img, y), CasCpuRowW(dst.img, out)))
+                out++;
+        if (CasCpuStreamFinish(stream, CasCpuRowW(dst.img, out)))
+            out++;
+        break;
+    }
+    case PATH_RGBA8:
+    {
+        CasCpuFix fix;
+        CasCpuFixSetup(fix, const1);
+        CasCpuFilterRgba8(dst.img, src.img, fix);
+        break;
+    }
+    case PATH_PACKED:
+        CasCpuFilterH(dst.img, src.img, const0, const1, noScaling);
+        break;
+    case PATH_BATCH:
+    {
+        Surface copies[BATCH_FRAMES - 1][2];
+        CasCpuImage srcs[BATCH_FRAMES] = { src.img }, dsts[BATCH_FRAMES] = { dst.img };
+        for (uint32_t f = 1; f < BATCH_FRAMES; f++)
+        {
+            SurfaceInit(copies[f - 1][0], p.inFormat, inW, inH);
+            SurfaceInit(copies[f - 1][1], p.outFormat, outW, outH);
+            memcpy(copies[f - 1][0].mem.data(), src.mem.data(), src.mem.size());
+            srcs[f] = copies[f - 1][0].img;
+            dsts[f] = copies[f - 1][1].img;
+            srcs[f].transfer = dsts[f].transfer = p.transfer;
+        }
+        // Both ways of splitting the work, tiles on half the cases and whole frames on the other.
+        uint32_t mode = st.cases & 1 ? CAS_CPU_BATCH_FRAMES : CAS_CPU_BATCH_TILES;
+        failed = !CasCpuFilterBatch(pool, dsts, srcs, BATCH_FRAMES, const0, const1, noScaling, nullptr, mode, 7, 5);
+        for (uint32_t f = 1; f < BATCH_FRAMES; f++)
+            failed = failed || memcmp(copies[f - 1][1].mem.data(), dst.mem.data(), dst.mem.size()) != 0;
+        break;
+    }
+    case PATH_YUV:
+    {
+        // The source is the luma plane, chroma is noise which is copied when sharpening only.
+        CasCpuYuv in, out;
+        CasCpuYuvInit(in, inW, inH, p.inFormat);
+        CasCpuYuvInit(out, outW, outH, p.outFormat);
+        in.y = src.img;
+        out.y = dst.img;
+        for (size_t i = 0; i < in.mem.size(); i++)
+            in.mem[i] = uint8_t(Hash(uint32_t(i)));
+        failed = !CasCpuFilterYuv(pool, out, in, const0, const1, noScaling);
+        if (noScaling)
+            failed = failed || memcmp(out.u.data, in.u.data, in.u.pitch * in.u.height) != 0 ||
+                memcmp(out.v.data, in.v.data, in.v.pitch * in.v.height) != 0;
+        break;
+    }
+    case PATH_CONVERT:
+    {
+        Surface planarIn, planarOut;
+        SurfaceInit(planarIn, CAS_CPU_FORMAT_PLANAR32F, inW, inH);
+        SurfaceInit(planarOut, CAS_CPU_FORMAT_PLANAR32F, outW, outH);
+        CasCpuConvert(planarIn.img, src.img);
+        CasCpuFilter(planarOut.img, planarIn.img, const0, const1, noScaling);
+        CasCpuConvert(dst.img, planarOut.img);
+        break;
+    }
+    case PATH_VARIANT:
+    {
+        // The variant bits are the CAS_CONFORMANCE_VARIANT bits, so both calls run the kernel CasCpuFilter() does.
+        Surface ref, tiled;
+        SurfaceInit(ref, p.outFormat, outW, outH);
+        SurfaceInit(tiled, p.outFormat, outW, outH);
+        CasCpuFilterVariant(dst.img, src.img, const0, const1, noScaling, CAS_CONFORMANCE_VARIANT);
+        CasCpuFilterTiledVariant(pool, tiled.img, src.img, const0, const1, noScaling, CAS_CONFORMANCE_VARIANT, 7, 5);
+        CasCpuFilter(ref.img, src.img, const0, const1, noScaling);
+        failed = memcmp(dst.mem.data(), ref.mem.data(), ref.mem.size()) != 0 ||
+            memcmp(tiled.mem.data(), ref.mem.data(), ref.mem.size()) != 0;
+        break;
+    }
+    }
+
+    // Channels stored by the output format.
+    uint32_t k0 = 0, k1 = 4;
+    if (CasCpuFormatMono(p.outFormat))
+    {
+        k0 = 1;
+        k1 = 2;
+    }
+    else if (p.outFormat == CAS_CPU_FORMAT_RGB32F || p.outFormat == CAS_CPU_FORMAT_RGB8 ||
+        p.outFormat == CAS_CPU_FORMAT_RGB16)
+        k1 = 3;
+
+    double maxAbs = 0.0, sumSq = 0.0;
+    uint64_t count = 0, refClipped = 0, clipped = 0;
+    for (uint32_t y = 0; y < outH; y++)
+        for (uint32_t x = 0; x < outW; x++)
+        {
+            RefPixel rp;
+            RefFilter(rp, seen, x, y, const0, const1, noScaling);
+            float out[4];
+            SurfaceLoad(dst, x, y, out);
+            if (p.maxNits != 0.0f)
+                RefScRgb(rp, p.maxNits);
+            bool pixelRefClipped = false, pixelClipped = false;
+            for (uint32_t k = k0; k < k1; k++)
+            {
+                double r = rp.pix[k];
+                if (k == 3)
+                {
+                    r = RefAlpha(p.outFormat, r);
+                    for (uint32_t a = 1; a < rp.alphas; a++)
+                        if (AbsError(out[k], RefAlpha(p.outFormat, rp.alpha[a])) < AbsError(out[k], r))
+                            r = RefAlpha(p.outFormat, rp.alpha[a]);
+                }
+                if (k < 3 && p.maxNits == 0.0f)
+                {
+                    bool lo = !(rp.raw[k] >= 0.0), hi = rp.raw[k] > 1.0;
+                    pixelRefClipped = pixelRefClipped || lo || hi;
+                    pixelClipped = pixelClipped || (lo && out[k] == 0.0f) || (hi && out[k] == 1.0f);
+                }
+                if (k < 3)
+                {
+                    if (p.kind == PATH_RGBA8)
+                        r = sqrt(r);
+                    r = CasCpuTransferEncodeD(p.transfer, r);
+                }
+                double e = AbsError(out[k], r);
+                maxAbs = std::max(maxAbs, e);
+                sumSq += e * e;
+                count++;
+                st.ulp[UlpBucket(UlpDistance(p.outFormat, out[k], r))]++;
+            }
+            refClipped += pixelRefClipped;
+            clipped += pixelClipped;
+        }
+
+    if (failed)
+        maxAbs = INFINITY;
+    double mse = sumSq / double(count);
+    double psnr = mse > 0.0 ? 10.0 * log10(1.0 / mse) : INFINITY;
+    if (st.cases == 0 || maxAbs > st.maxAbs)
+    {
+        st.maxAbs = maxAbs;
+        st.maxAbsCase = c.name;
+    }
+    if (st.cases == 0 || psnr < st.minPsnr)
+    {
+        st.minPsnr = psnr;
+        st.minPsnrCase = c.name;
+    }
+    st.refClipped += refClipped;
+    st.clipped += clipped;
+    st.cases++;
+    if (verbose)
+        printf("  %-16s %-44s max abs %.3e  psnr %6.1f  clipped %llu/%llu\n", p.name.c_str(), c.name.c_str(), maxAbs,
+            psnr, (unsigned long long)clipped, (unsigned long long)refClipped);
+}
+
+//--------------------------------------------------------------------------------------
+//
+// Thread pool
+//
+//--------------------------------------------------------------------------------------
+// Back-to-back small jobs on more workers than tasks, so workers are still looking for work of one job when the next is
+// published. Every task of every job must run exactly once, a lost task hangs (ctest has a timeout).
+#define POOL_RUNS 4000
+#define POOL_MAX_TASKS 16
+
+struct PoolHits
+{
+    std::atomic<uint32_t> hits[POOL_MAX_TASKS];
+};
+
+static void PoolTask(void* ctx, uint32_t task, uint32_t worker)
+{
+    ((PoolHits*)ctx)->hits[task].fetch_add(1);
+    // Give the other workers a chance to steal on a machine with few cores.
+    if ((task ^ worker) & 1)
+        std::this_thread::yield();
+}
+
+static bool PoolStress(bool quiet)
+{
+    CasCpuPool pool(8);
+    PoolHits h;
+    for (uint32_t i = 0; i < POOL_RUNS; i++)
+    {
+        uint32_t tasks = 1 + i % POOL_MAX_TASKS;
+        for (uint32_t t = 0; t < tasks; t++)
+            h.hits[t].store(0);
+        pool.Run(tasks, PoolTask, &h);
+        for (uint32_t t = 0; t < tasks; t++)
+            if (h.hits[t].load() != 1)
+            {
+                printf("%-16s run %u of %u tasks ran task %u %u times  FAIL\n", "pool", i, tasks, t,
+                    h.hits[t].load());
+                return false;
+            }
+    }
+    if (!quiet)
+        printf("%-16s %u back-to-back runs of 1 to %u tasks on %u workers  ok\n", "pool", POOL_RUNS, POOL_MAX_TASKS,
+            pool.Threads());
+    return true;
+}
+
+// CasCpuTileCount() must cover the image in at most the task limit, growing the tiles only when the limit needs it.
+static const struct
+{
+    uint32_t w, h, tileW, tileH, maxTasks;
+} s_tileCounts[] =
+{
+    { 1920, 1080, 16, 16, CAS_CPU_TASKS_MAX },
+    { 65536, 65536, 1, 1, CAS_CPU_TASKS_MAX },
+    { 0xffffffffu, 0xffffffffu, 16, 16, CAS_CPU_TASKS_MAX },
+    { 0xffffffffu, 3, 0xffffffffu, 16, CAS_CPU_TASKS_MAX },
+    { 4096, 4096, 16, 16, CAS_CPU_TASKS_MAX / 1000000u },
+    { 4096, 4096, 16, 16, 1 },
+};
+
+static bool TileCounts(bool quiet)
+{
+    for (const auto& c : s_tileCounts)
+    {
+        uint32_t tileW = c.tileW, tileH = c.tileH, tilesX;
+        uint32_t n = CasCpuTileCount(tileW, tileH, tilesX, c.w, c.h, c.maxTasks);
+        uint64_t tilesY = (uint64_t(c.h) + tileH - 1) / tileH;
+        uint64_t want = ((uint64_t(c.w) + c.tileW - 1) / c.tileW) * ((uint64_t(c.h) + c.tileH - 1) / c.tileH);
+        bool kept = tileW == std::min(c.tileW, c.w) && tileH == std::min(c.tileH, c.h);
+        bool ok = n <= c.maxTasks && tilesX * tilesY == n && uint64_t(tilesX) * tileW >= c.w &&
+            tilesY * tileH >= c.h && (want > c.maxTasks || kept);
+        if (!ok)
+        {
+            printf("%-16s %ux%u in %ux%u tiles, at most %u, got %u tasks of %ux%u  FAIL\n", "tiles", c.w, c.h, c.tileW,
+                c.tileH, c.maxTasks, n, tileW, tileH);
+            return false;
+        }
+    }
+    if (!quiet)
+        printf("%-16s %zu tile counts within the task limit  ok\n", "tiles",
+            sizeof(s_tileCounts) / sizeof(s_tileCounts[0]));
+    return true;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// Half arrays
+//
+//--------------------------------------------------------------------------------------
+// AF1N_AH1N() and AH1N_AF1N() must give the bits of AF1_AH1_AU1() and AU1_AH1_AF1(), on every half, and on a strided
+// sweep of the float bit patterns in runs of 1 to HALF_MAX_RUN so the SIMD loops end in every tail length.
+// Each SIMD form the CPU has runs too, not only the one the dispatch picks.
+#define HALF_STRIDE 4093u
+#define HALF_MAX_RUN 37u
+
+typedef uint32_t (*HalfToFn)(AW1* d, const AF1* s, uint32_t n);
+typedef uint32_t (*HalfFromFn)(AF1* d, const AW1* s, uint32_t n);
+
+static uint32_t HalfToAll(AW1* d, const AF1* s, uint32_t n)
+{
+    AH1N_AF1N(d, s, n);
+    return n;
+}
+
+static uint32_t HalfFromAll(AF1* d, const AW1* s, uint32_t n)
+{
+    AF1N_AH1N(d, s, n);
+    return n;
+}
+
+static bool HalfArrays(bool quiet)
+{
+    struct
+    {
+        const char* name;
+        HalfToFn to;
+        HalfFromFn from;
+        bool supported;
+    } forms[] =
+    {
+        { "dispatch", HalfToAll, HalfFromAll, true },
+#ifdef A_CPU_F16C
+        { "f16c", AH1N_AF1N_F16c, AF1N_AH1N_F16c, AHalfSimd() >= 1 },
+        { "avx512", AH1N_AF1N_Avx512, AF1N_AH1N_Avx512, AHalfSimd() >= 2 },
+#endif
+    };
+    std::vector<AW1> halves(65536), h(65536);
+    std::vector<AF1> f(65536);
+    for (uint32_t i = 0; i < 65536; i++)
+        halves[i] = AW1(i);
+    std::vector<AF1> floats;
+    for (uint64_t u = 0; u < (1ull << 32); u += HALF_STRIDE)
+        floats.push_back(AF1_AU1(uint32_t(u)));
+    std::vector<AW1> out(floats.size());
+    uint32_t forms_run = 0;
+    for (const auto& form : forms)
+    {
+        if (!form.supported)
+            continue;
+        // The SIMD forms return how many they did, the rest is left to the scalar functions as AH1N_AF1N() does.
+        uint32_t done = form.from(f.data(), halves.data(), 65536);
+        for (uint32_t i = done; i < 65536; i++)
+            f[i] = AF1_AH1_AU1(i);
+        for (uint32_t i = 0; i < 65536; i++)
+            if (AU1_AF1(f[i]) != AU1_AF1(AF1_AH1_AU1(i)))
+            {
+                printf("%-16s %s half %04x to float is %08x, not %08x  FAIL\n", "half", form.name, i, AU1_AF1(f[i]),
+                    AU1_AF1(AF1_AH1_AU1(i)));
+                return false;
+            }
+        for (size_t i = 0, run = 1; i < floats.size(); i += run, run = run % HALF_MAX_RUN + 1)
+        {
+            uint32_t n = uint32_t(std::min(run, floats.size() - i));
+            uint32_t k = form.to(out.data() + i, floats.data() + i, n);
+            for (; k < n; k++)
+                out[i + k] = AW1(AU1_AH1_AF1(floats[i + k]));
+        }
+        for (size_t i = 0; i < floats.size(); i++)
+            if (out[i] != AW1(AU1_AH1_AF1(floats[i])))
+            {
+                printf("%-16s %s float %08x to half is %04x, not %04x  FAIL\n", "half", form.name, AU1_AF1(floats[i]),
+                    out[i], AU1_AH1_AF1(floats[i]));
+                return false;
+            }
+        forms_run++;
+    }
+    if (!quiet)
+        printf("%-16s %u forms of AF1N_AH1N() and AH1N_AF1N() match the scalar ones on all halves and %zu floats  ok\n",
+            "half", forms_run, floats.size());
+    return true;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// Approximations
+//
+//--------------------------------------------------------------------------------------
+// The VPrx*() of every kernel must give the bits of the APrx*F1() they port, on a strided sweep of the float bit patterns.
+// The AVX2 and AVX-512 kernels fuse the Newton-Raphson step of VPrxMedRcp(), the reference fuses it too with fmaf().
+// NaN results match any NaN, which operand of a multiply x86 passes on is the compiler's choice.
+// The half and rsq forms of 'ffx_a.h', which CAS does not call, are checked against the integer formulas of the GPU.
+#define PRX_STRIDE 4099u
+
+#ifdef A_GCC
+#define PRX_TARGET(t) __attribute__((target(t)))
+#else
+#define PRX_TARGET(t)
+#endif
+
+// 'd' gets VPrxLoSqrt(), VPrxLoRcp() and VPrxMedRcp() of 's', one after the other, 'n' is a multiple of 16.
+#define PRX_KERNEL(ns, target)                                                                                     \
+    target static void Prx##ns(AF1* d, const AF1* s, size_t n)                                          \
+    {                                                                                                              \
+        for (size_t i = 0; i < n; i += ns::VN)                                                                     \
+        {                                                                                                          \
+            ns::VSt(d + i, ns::VPrxLoSqrt(ns::VLd(s + i)));                                                        \
+            ns::VSt(d + n + i, ns::VPrxLoRcp(ns::VLd(s + i)));                                                     \
+            ns::VSt(d + 2 * n + i, ns::VPrxMedRcp(ns::VLd(s + i)));                                                \
+        }                                                                                                          \
+    }
+
+PRX_KERNEL(CasCpuScalar, )
+#ifdef CAS_CPU_X86
+PRX_KERNEL(CasCpuSse41, PRX_TARGET("sse4.1"))
+PRX_KERNEL(CasCpuAvx2, PRX_TARGET("avx2,fma,f16c"))
+PRX_KERNEL(CasCpuAvx512, PRX_TARGET("avx512f,avx2,fma,f16c"))
+#endif
+
+#ifdef A_AVX
+PRX_TARGET("avx2") static void PrxAvxLoRsq(AF1* d, const AF1* s, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8)
+        _mm256_storeu_ps(d + i, AAvxPrxLoRsqF8(_mm256_loadu_ps(s + i)));
+}
+#endif
+
+static bool PrxFail(const char* form, uint32_t in, uint32_t out, uint32_t ref)
+{
+    printf("%-16s %s of %08x is %08x, not %08x  FAIL\n", "prx", form, in, out, ref);
+    return false;
+}
+
+static bool Approximations(bool quiet)
+{
+    typedef void (*PrxFn)(AF1* d, const AF1* s, size_t n);
+    PrxFn kernels[CAS_CPU_KERNEL_COUNT] = { PrxCasCpuScalar };
+#ifdef CAS_CPU_X86
+    kernels[CAS_CPU_KERNEL_SSE41] = PrxCasCpuSse41;
+    kernels[CAS_CPU_KERNEL_AVX2] = PrxCasCpuAvx2;
+    kernels[CAS_CPU_KERNEL_AVX512] = PrxCasCpuAvx512;
+#endif
+    std::vector<AF1> s;
+    for (uint64_t u = 0; u < (1ull << 32); u += PRX_STRIDE)
+        s.push_back(AF1_AU1(uint32_t(u)));
+    s.resize((s.size() + 15) & ~size_t(15), 1.0f);
+    size_t n = s.size();
+    std::vector<AF1> d(3 * n);
+    uint32_t kernelsRun = 0;
+    for (uint32_t k = 0; k <= CasCpuKernelSupported() && k < CAS_CPU_KERNEL_COUNT; k++)
+    {
+        if (!kernels[k])
+            continue;
+        kernels[k](d.data(), s.data(), n);
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t u = AU1_AF1(s[i]);
+            AF1 b = AF1_AU1(0x7ef19fffu - u);
+            AF1 ref[3] = { APrxLoSqrtF1(s[i]), APrxLoRcpF1(s[i]),
+                k >= CAS_CPU_KERNEL_AVX2 ? b * fmaf(-b, s[i], 2.0f) : APrxMedRcpF1(s[i]) };
+            static const char* const names[3] = { "VPrxLoSqrt()", "VPrxLoRcp()", "VPrxMedRcp()" };
+            for (uint32_t f = 0; f < 3; f++)
+                if (AU1_AF1(d[f * n + i]) != AU1_AF1(ref[f]) && (d[f * n + i] == d[f * n + i] || ref[f] == ref[f]))
+                    return PrxFail((std::string(CasCpuKernelName(k)) + " " + names[f]).c_str(), u,
+                        AU1_AF1(d[f * n + i]), AU1_AF1(ref[f]));
+        }
+        kernelsRun++;
+    }
+
+    // Each 16-bit lane on its own, as the GPU does on 16-bit integers.
+    for (uint32_t a = 0; a < 65536; a++)
+    {
+        uint32_t b = Hash(a) & 0xffffu, ab = a | (b << 16);
+        uint32_t sqrtA = uint16_t((a >> 1) + 0x1de2u), sqrtB = uint16_t((b >> 1) + 0x1de2u);
+        uint32_t rcpA = uint16_t(0x7784u - a), rcpB = uint16_t(0x7784u - b);
+        uint32_t rsqA = uint16_t(0x59a3u - (a >> 1)), rsqB = uint16_t(0x59a3u - (b >> 1));
+        if (APrxLoSqrtH1(a) != sqrtA)
+            return PrxFail("APrxLoSqrtH1()", a, APrxLoSqrtH1(a), sqrtA);
+        if (APrxLoRcpH1(a) != rcpA)
+            return PrxFail("APrxLoRcpH1()", a, APrxLoRcpH1(a), rcpA);
+        if (APrxLoRsqH1(a) != rsqA)
+            return PrxFail("APrxLoRsqH1()", a, APrxLoRsqH1(a), rsqA);
+        if (APrxLoSqrtH2(ab) != (sqrtA | (sqrtB << 16)))
+            return PrxFail("APrxLoSqrtH2()", ab, APrxLoSqrtH2(ab), sqrtA | (sqrtB << 16));
+        if (APrxLoRcpH2(ab) != (rcpA | (rcpB << 16)))
+            return PrxFail("APrxLoRcpH2()", ab, APrxLoRcpH2(ab), rcpA | (rcpB << 16));
+        if (APrxLoRsqH2(ab) != (rsqA | (rsqB << 16)))
+            return PrxFail("APrxLoRsqH2()", ab, APrxLoRsqH2(ab), rsqA | (rsqB << 16));
+    }
+
+    // The float rsq, which has no kernel using it.
+    std::vector<AF1> rsq(n);
+    for (size_t i = 0; i < n; i++)
+        rsq[i] = APrxLoRsqF1(s[i]);
+#ifdef A_CPU_SSE
+    for (size_t i = 0; i < n; i += 4)
+        _mm_storeu_ps(&d[i], ASsePrxLoRsqF4(_mm_loadu_ps(&s[i])));
+#else
+    d.assign(rsq.begin(), rsq.end());
+#endif
+#ifdef A_AVX
+    if (CasCpuKernelSupported() >= CAS_CPU_KERNEL_AVX2)
+        PrxAvxLoRsq(&d[n], s.data(), n);
+    else
+        std::copy(rsq.begin(), rsq.end(), d.begin() + n);
+#else
+    std::copy(rsq.begin(), rsq.end(), d.begin() + n);
+#endif
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t u = AU1_AF1(s[i]), ref = 0x5f347d74u - (u >> 1);
+        if (AU1_AF1(rsq[i]) != ref)
+            return PrxFail("APrxLoRsqF1()", u, AU1_AF1(rsq[i]), ref);
+        if (AU1_AF1(d[i]) != ref)
+            return PrxFail("ASsePrxLoRsqF4()", u, AU1_AF1(d[i]), ref);
+        if (AU1_AF1(d[n + i]) != ref)
+            return PrxFail("AAvxPrxLoRsqF8()", u, AU1_AF1(d[n + i]), ref);
+    }
+    if (!quiet)
+        printf("%-16s VPrx*() of %u kernels match APrx*F1() on %zu floats, half and rsq forms match the GPU  ok\n", "prx",
+            kernelsRun, n);
+    return true;
+}
+
+#if CAS_CONFORMANCE_SSE
+// In 'CAS_ConformanceSse.cpp', which is built with A_SSE.
+bool SseOps(bool quiet);
+#endif
+
+//--------------------------------------------------------------------------------------
+//
+// Fixed sizes
+//
+//--------------------------------------------------------------------------------------
+// CasCpuFilterFixed() and CasCpuFilterFixedTiled() must store the same bytes as CasCpuFilter() on every kernel.
+// Odd sizes, scaling and sharpen-only, on noise.
+#if CAS_CPU_FIXED
+template <uint32_t inW, uint32_t inH, uint32_t outW, uint32_t outH>
+static bool FixedSize(CasCpuPool& pool, bool quiet)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "fixed %ux%u->%ux%u", inW, inH, outW, outH);
+    bool noScaling = CasCpuSize<inW, inH, outW, outH>::noScaling;
+    Surface src, ref, fixed, tiled;
+    SurfaceInit(src, CAS_CPU_FORMAT_RGBA32F, inW, inH);
+    SurfaceInit(ref, CAS_CPU_FORMAT_RGBA32F, outW, outH);
+    SurfaceInit(fixed, CAS_CPU_FORMAT_RGBA32F, outW, outH);
+    SurfaceInit(tiled, CAS_CPU_FORMAT_RGBA32F, outW, outH);
+    for (uint32_t y = 0; y < inH; y++)
+        for (uint32_t x = 0; x < inW; x++)
+        {
+            float v[4];
+            for (uint32_t c = 0; c < 4; c++)
+                v[c] = Noise(x, y, c);
+            SurfaceStore(src, x, y, v);
+        }
+    uint32_t runs = 0;
+    for (uint32_t k = 0; k <= CasCpuKernelSupported(); k++)
+        for (float s : s_sharpness)
+        {
+            CasCpuKernelSet(k);
+            varAU4(const0);
+            varAU4(const1);
+            CasSetup(const0, const1, s, AF1(inW), AF1(inH), AF1(outW), AF1(outH));
+            CasCpuFilter(ref.img, src.img, const0, const1, noScaling);
+            CasCpuFilterFixed<inW, inH, outW, outH>(fixed.img, src.img, const1);
+            CasCpuFilterFixedTiled<inW, inH, outW, outH>(pool, tiled.img, src.img, const1, 7, 5);
+            const char* differs = memcmp(fixed.mem.data(), ref.mem.data(), ref.mem.size()) ? "CasCpuFilterFixed" :
+                memcmp(tiled.mem.data(), ref.mem.data(), ref.mem.size()) ? "CasCpuFilterFixedTiled" : nullptr;
+            if (differs)
+            {
+                printf("%-16s %s on %s at sharpness %.1f differs from CasCpuFilter()  FAIL\n", name, differs,
+                    CasCpuKernelName(k), s);
+                return false;
+            }
+            runs++;
+        }
+    if (!quiet)
+        printf("%-16s %u runs of CasCpuFilterFixed() and CasCpuFilterFixedTiled() match CasCpuFilter()  ok\n", name,
+            runs);
+    return true;
+}
+#endif
+
+//--------------------------------------------------------------------------------------
+//
+// main
+//
+//--------------------------------------------------------------------------------------
+static void PrintUsage()
+{
+    printf(
+        "Usage: CAS_Conformance [options]\n"
+        "Checks the CPU paths built with the '%s' CAS options against a double precision reference.\n"
+        "  --verbose               Print every case\n"
+        "  --quiet                 Only print the paths which fail\n"
+        "  --path <name>           Only run paths starting with this, such as 'rgba16f', 'tiled/avx2', 'pool'\n"
+        "                          'tiles', 'half', 'prx', 'sse' or 'fixed'\n",
+        s_variantNames[CAS_CONFORMANCE_VARIANT]);
+}
+
+static void PrintHeader()
+{
+    printf("%-16s %6s %-10s %-44s %7s %-44s", "path", "cases", "max abs", "worst case", "psnr", "worst case");
+    for (uint32_t b = 0; b < ULP_BUCKETS; b++)
+        printf(" %8s", s_ulpBucketNames[b]);
+    printf(" %15s  result\n", "clipped");
+}
+
+static void PrintStats(const Path& p, const Stats& st, bool pass)
+{
+    printf("%-16s %6u %.4e %-44s %7.1f %-44s", p.name.c_str(), st.cases, st.maxAbs, st.maxAbsCase.c_str(), st.minPsnr,
+        st.minPsnrCase.c_str());
+    for (uint32_t b = 0; b < ULP_BUCKETS; b++)
+        printf(" %8llu", (unsigned long long)st.ulp[b]);
+    printf(" %7llu/%-7llu  %s\n", (unsigned long long)st.clipped, (unsigned long long)st.refClipped,
+        pass ? "ok" : "FAIL");
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = false;
+    bool quiet = false;
+    const char* only = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--verbose"))
+            verbose = true;
+        else if (!strcmp(argv[i], "--quiet"))
+            quiet = true;
+        else if (!strcmp(argv[i], "--path") && i + 1 < argc)
+            only = argv[++i];
+        else
+        {
+            PrintUsage();
+            return strcmp(argv[i], "--help") ? 1 : 0;
+        }
+    }
+
+    std::vector<Case> cases = Cases();
+    std::vector<Path> paths = Paths();
+    CasCpuPool pool(4);
+    printf("CAS conformance, variant %s, best kernel %s, %zu cases\n", s_variantNames[CAS_CONFORMANCE_VARIANT],
+        CasCpuKernelName(CasCpuKernelSupported()), cases.size());
+    bool header = !quiet;
+    if (header)
+        PrintHeader();
+
+    uint32_t failed = 0;
+    if (!only || !strncmp("pool", only, strlen(only)))
+        failed += !PoolStress(quiet);
+    if (!only || !strncmp("tiles", only, strlen(only)))
+        failed += !TileCounts(quiet);
+    if (!only || !strncmp("half", only, strlen(only)))
+        failed += !HalfArrays(quiet);
+    if (!only || !strncmp("prx", only, strlen(only)))
+        failed += !Approximations(quiet);
+#if CAS_CONFORMANCE_SSE
+    if (!only || !strncmp("sse", only, strlen(only)))
+        failed += !SseOps(quiet);
+#endif
+#if CAS_CPU_FIXED
+    if (!only || !strncmp("fixed", only, strlen(only)))
+    {
+        failed += !FixedSize<97, 53, 150, 80>(pool, quiet);
+        failed += !FixedSize<97, 53, 97, 53>(pool, quiet);
+    }
+#endif
+    for (const Path& p : paths)
+    {
+        if (only && strncmp(p.name.c_str(), only, strlen(only)))
+            continue;
+        if (p.kernel > CasCpuKernelSupported())
+        {
+            if (!quiet)
+                printf("%-16s skipped, the CPU lacks the kernel\n", p.name.c_str());
+            continue;
+        }
+        CasCpuKernelSet(p.kernel);
+        Stats st;
+        for (const Case& c : cases)
+        {
+            bool noScaling = c.image->w == c.outW && c.image->h == c.outH;
+            if (!p.scaling && !noScaling)
+                continue;
+            // CasCpuFilterYuv() refuses scaling beyond what CasSupportScaling() allows.
+            if (p.kind == PATH_YUV && !noScaling &&
+                !CasSupportScaling(AF1(c.outW), AF1(c.outH), AF1(c.image->w), AF1(c.image->h)))
+                continue;
+            RunPath(p, c, pool, st, verbose);
+        }
+
+        const Tolerance* t = FindTolerance(p.group);
+        bool pass = t && st.maxAbs <= t->maxAbs && st.minPsnr >= t->minPsnr;
+        if (!pass && !header)
+        {
+            PrintHeader();
+            header = true;
+        }
+        if (!quiet || !pass)
+            PrintStats(p, st, pass);
+        if (!pass)
+        {
+            failed++;
+            if (!t)
+                printf("  no tolerance for '%s'\n", p.group);
+            else
+                printf("  allowed max abs %.4e, psnr %.1f\n", t->maxAbs, t->minPsnr);
+        }
+    }
+    printf("%s\n", failed ? "FAILED" : "PASSED");
+    return failed ? 1 : 0;
+}
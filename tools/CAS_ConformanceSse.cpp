@@ -0,0 +1,166 @@
+//CAS Conformance
+//
+// Copyright(c) 2020 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// The 'ffx_a.h' AF2, AF3 and AF4 vector ops built with A_SSE, which nothing else in the tree turns on.
+// Its own translation unit, so the rest of CAS_Conformance keeps the scalar ops.
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define A_CPU 1
+#define A_SSE 1
+#if defined(__GNUC__)
+#define A_GCC 1
+#endif
+#include "ffx_a.h"
+
+//--------------------------------------------------------------------------------------
+//
+// SSE vector ops
+//
+//--------------------------------------------------------------------------------------
+// Every op*F2/F3/F4() must give the bits of its A*F1() per lane, on every combination of the edge case values below
+// spread over the lanes, and must not write past its width.
+// Abs, copy, negate, min and max must match exactly, NaN included, so min and max keep the operand order of AMinF1()
+// and AMaxF1(). Arithmetic NaN results match any NaN, which operand of an add or multiply x86 passes on is the
+// compiler's choice.
+#define SSE_SENTINEL 0x12345678u
+
+static const uint32_t s_sseValues[] =
+{
+    0x00000000u, // 0
+    0x80000000u, // -0
+    0x3f800000u, // 1
+    0xbf800000u, // -1
+    0x3f000000u, // 0.5
+    0xc0200000u, // -2.5
+    0x3fc00000u, // 1.5
+    0x7f800000u, // INF
+    0xff800000u, // -INF
+    0x7fc00000u, // NaN
+    0xffc00001u, // -NaN with a payload
+    0x7f7fffffu, // FLT_MAX
+    0xff7fffffu, // -FLT_MAX
+    0x00800000u, // FLT_MIN
+    0x00000001u, // smallest denormal
+    0x80400000u, // -denormal
+};
+
+#define SSE_VALUES (sizeof(s_sseValues) / sizeof(s_sseValues[0]))
+
+typedef void (*SseRunFn)(AF1* d, AF1* a, AF1* b, AF1* c);
+
+struct SseOp
+{
+    const char* name;
+    // Reference of one lane, 'c' is lane 0 of 'c' for the *One() ops.
+    AF1 (*ref)(AF1 a, AF1 b, AF1 c);
+    SseRunFn run[3];
+    bool one;
+    bool arith;
+};
+
+static AF1 SseRefAbs(AF1 a, AF1, AF1) { return AAbsF1(a); }
+static AF1 SseRefAdd(AF1 a, AF1 b, AF1) { return a + b; }
+static AF1 SseRefCpy(AF1 a, AF1, AF1) { return a; }
+static AF1 SseRefLerp(AF1 a, AF1 b, AF1 c) { return ALerpF1(a, b, c); }
+static AF1 SseRefMax(AF1 a, AF1 b, AF1) { return AMaxF1(a, b); }
+static AF1 SseRefMin(AF1 a, AF1 b, AF1) { return AMinF1(a, b); }
+static AF1 SseRefMul(AF1 a, AF1 b, AF1) { return a * b; }
+static AF1 SseRefMulOne(AF1 a, AF1, AF1 c) { return a * c; }
+static AF1 SseRefNeg(AF1 a, AF1, AF1) { return -a; }
+static AF1 SseRefRcp(AF1 a, AF1, AF1) { return ARcpF1(a); }
+
+#define SSE_RUN(op, w, args)                                                                                        \
+    static void SseRun##op##w(AF1* d, AF1* a, AF1* b, AF1* c)                                                      \
+    {                                                                                                               \
+        (void)b;                                                                                                    \
+        (void)c;                                                                                                    \
+        opA##op##F##w args;                                                                                         \
+    }
+#define SSE_RUNS(op, args) SSE_RUN(op, 2, args) SSE_RUN(op, 3, args) SSE_RUN(op, 4, args)
+
+SSE_RUNS(Abs, (d, a))
+SSE_RUNS(Add, (d, a, b))
+SSE_RUNS(Cpy, (d, a))
+SSE_RUNS(Lerp, (d, a, b, c))
+SSE_RUNS(LerpOne, (d, a, b, c[0]))
+SSE_RUNS(Max, (d, a, b))
+SSE_RUNS(Min, (d, a, b))
+SSE_RUNS(Mul, (d, a, b))
+SSE_RUNS(MulOne, (d, a, c[0]))
+SSE_RUNS(Neg, (d, a))
+SSE_RUNS(Rcp, (d, a))
+
+#define SSE_OP(op, ref, one, arith) { #op, ref, { SseRun##op##2, SseRun##op##3, SseRun##op##4 }, one, arith }
+
+static const SseOp s_sseOps[] =
+{
+    SSE_OP(Abs, SseRefAbs, false, false),
+    SSE_OP(Add, SseRefAdd, false, true),
+    SSE_OP(Cpy, SseRefCpy, false, false),
+    SSE_OP(Lerp, SseRefLerp, false, true),
+    SSE_OP(LerpOne, SseRefLerp, true, true),
+    SSE_OP(Max, SseRefMax, false, false),
+    SSE_OP(Min, SseRefMin, false, false),
+    SSE_OP(Mul, SseRefMul, false, true),
+    SSE_OP(MulOne, SseRefMulOne, true, true),
+    SSE_OP(Neg, SseRefNeg, false, false),
+    SSE_OP(Rcp, SseRefRcp, false, true),
+};
+
+static bool SseNaN(uint32_t u)
+{
+    return (u & 0x7fffffffu) > 0x7f800000u;
+}
+
+bool SseOps(bool quiet)
+{
+    uint32_t checked = 0;
+    for (const SseOp& op : s_sseOps)
+        for (uint32_t w = 2; w <= 4; w++)
+            for (uint32_t i = 0; i < SSE_VALUES * SSE_VALUES * SSE_VALUES; i++)
+            {
+                // Lane 'k' gets a different combination of values, so each lane of each op sees every pair.
+                AF1 a[4], b[4], c[4], d[4];
+                for (uint32_t k = 0; k < 4; k++)
+                {
+                    a[k] = AF1_AU1(s_sseValues[(i + k) % SSE_VALUES]);
+                    b[k] = AF1_AU1(s_sseValues[(i / SSE_VALUES + 3 * k) % SSE_VALUES]);
+                    c[k] = AF1_AU1(s_sseValues[(i / (SSE_VALUES * SSE_VALUES) + 5 * k) % SSE_VALUES]);
+                    d[k] = AF1_AU1(SSE_SENTINEL);
+                }
+                op.run[w - 2](d, a, b, c);
+                for (uint32_t k = 0; k < 4; k++)
+                {
+                    uint32_t got = AU1_AF1(d[k]);
+                    uint32_t want = k < w ? AU1_AF1(op.ref(a[k], b[k], op.one ? c[0] : c[k])) : SSE_SENTINEL;
+                    if (got == want || (k < w && op.arith && SseNaN(got) && SseNaN(want)))
+                        continue;
+                    printf("%-16s opA%sF%u lane %u of %08x %08x %08x is %08x, not %08x  FAIL\n", "sse", op.name, w, k,
+                        AU1_AF1(a[k]), AU1_AF1(b[k]), AU1_AF1(op.one ? c[0] : c[k]), got, want);
+                    return false;
+                }
+                checked++;
+            }
+    if (!quiet)
+        printf("%-16s %zu A_SSE vector ops match the scalar ones in %u calls  ok\n", "sse",
+            sizeof(s_sseOps) / sizeof(s_sseOps[0]) * 3, checked);
+    return true;
+}